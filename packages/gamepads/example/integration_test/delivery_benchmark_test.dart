@@ -0,0 +1,138 @@
+// Compares how events reach Dart on Linux: posted to a native port (the
+// default) or sent through the method channel.
+//
+// Fake gamepads are FIFOs created in the directory the plugin watches, which
+// has to be set when the application starts, along with taking FIFOs for
+// joysticks:
+//
+//   mkdir -p /tmp/gamepads-benchmark
+//   GAMEPADS_INPUT_DIR=/tmp/gamepads-benchmark GAMEPADS_INPUT_NODE_TYPE=fifo \
+//     flutter test integration_test/delivery_benchmark_test.dart -d linux
+//
+// Latency is measured from writing each event to receiving it, with events
+// spaced out so they are delivered one by one; throughput from writing a
+// burst of events at once to receiving the last one.
+import 'dart:async';
+import 'dart:io';
+import 'dart:typed_data';
+
+import 'package:flutter/foundation.dart';
+import 'package:flutter_test/flutter_test.dart';
+import 'package:gamepads_platform_interface/gamepads_platform_interface.dart';
+import 'package:gamepads_platform_interface/method_channel_gamepads_platform_interface.dart';
+import 'package:integration_test/integration_test.dart';
+
+const _latencyEvents = 2000;
+const _eventSpacing = Duration(milliseconds: 2);
+const _burstEvents = 4000;
+const _timeout = Duration(seconds: 30);
+
+void main() {
+  final binding = IntegrationTestWidgetsFlutterBinding.ensureInitialized();
+  final inputDir = Platform.environment['GAMEPADS_INPUT_DIR'];
+  final nodeType = Platform.environment['GAMEPADS_INPUT_NODE_TYPE'];
+
+  testWidgets(
+    'native port vs method channel',
+    (tester) async {
+      await tester.runAsync(() async {
+        // The plugin's own implementation, using native ports when the
+        // native library provides them.
+        final nativePort = await _benchmark(
+          GamepadsPlatformInterface.instance,
+          '$inputDir/js_native_port',
+        );
+        // Taking over the channel's handler; must run last.
+        final methodChannel = await _benchmark(
+          MethodChannelGamepadsPlatformInterface(),
+          '$inputDir/js_method_channel',
+        );
+        binding.reportData = {
+          'nativePort': nativePort,
+          'methodChannel': methodChannel,
+        };
+        debugPrint('Native port:    $nativePort');
+        debugPrint('Method channel: $methodChannel');
+      });
+    },
+    skip: !Platform.isLinux || inputDir == null || nodeType != 'fifo',
+    timeout: const Timeout(Duration(minutes: 2)),
+  );
+}
+
+/// Streams events through a fake gamepad at [path], returning the latency
+/// percentiles (in microseconds) and the throughput (in events per second).
+Future<Map<String, num>> _benchmark(
+  GamepadsPlatformInterface platform,
+  String path,
+) async {
+  final stopwatch = Stopwatch()..start();
+  final sentAt = List<int>.filled(_latencyEvents, 0);
+  final latencies = <int>[];
+  var received = 0;
+  var expected = _latencyEvents;
+  var done = Completer<void>();
+
+  final subscription = platform.gamepadEventsStream.listen((event) {
+    if (event.gamepadId != path) {
+      return;
+    }
+    if (latencies.length < _latencyEvents) {
+      final index = event.value.toInt();
+      latencies.add(stopwatch.elapsedMicroseconds - sentAt[index]);
+    }
+    if (++received == expected) {
+      done.complete();
+    }
+  });
+  // Let the subscription reach the plugin before the gamepad connects.
+  await Future<void>.delayed(const Duration(milliseconds: 200));
+
+  await Process.run('mkfifo', [path]);
+  // Opening blocks until the plugin opens the other end.
+  final gamepad = await File(path).open(mode: FileMode.writeOnly);
+  try {
+    for (var i = 0; i < _latencyEvents; i++) {
+      sentAt[i] = stopwatch.elapsedMicroseconds;
+      await gamepad.writeFrom(_record(i));
+      await Future<void>.delayed(_eventSpacing);
+    }
+    await done.future.timeout(_timeout);
+
+    received = 0;
+    expected = _burstEvents;
+    done = Completer<void>();
+    final burst = BytesBuilder(copy: false);
+    for (var i = 0; i < _burstEvents; i++) {
+      burst.add(_record(i));
+    }
+    final burstStart = stopwatch.elapsedMicroseconds;
+    await gamepad.writeFrom(burst.takeBytes());
+    await done.future.timeout(_timeout);
+    final burstUs = stopwatch.elapsedMicroseconds - burstStart;
+
+    latencies.sort();
+    int percentile(double p) => latencies[((latencies.length - 1) * p).round()];
+    return {
+      'p50Us': percentile(0.5),
+      'p90Us': percentile(0.9),
+      'p99Us': percentile(0.99),
+      'maxUs': latencies.last,
+      'eventsPerSecond': (_burstEvents * 1000000 / burstUs).round(),
+    };
+  } finally {
+    await subscription.cancel();
+    await gamepad.close();
+    await File(path).delete();
+  }
+}
+
+/// Encodes a `js_event` pressing button 0, with the event's index as value.
+Uint8List _record(int index) {
+  final record = ByteData(8)
+    ..setUint32(0, 0, Endian.host)
+    ..setInt16(4, index, Endian.host)
+    ..setUint8(6, 0x01)
+    ..setUint8(7, 0);
+  return record.buffer.asUint8List();
+}
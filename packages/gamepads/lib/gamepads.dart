@@ -1,4 +1,7 @@
 export 'package:gamepads_platform_interface/api/gamepad_controller.dart';
 export 'package:gamepads_platform_interface/api/gamepad_event.dart';
+export 'package:gamepads_platform_interface/api/gamepad_history.dart';
+export 'package:gamepads_platform_interface/api/gamepad_pattern.dart';
+export 'package:gamepads_platform_interface/api/gamepad_snapshot.dart';
 
 export 'src/gamepads.dart';
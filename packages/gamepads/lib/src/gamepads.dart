@@ -2,6 +2,9 @@ library gamepads;
 
 import 'package:gamepads_platform_interface/api/gamepad_controller.dart';
 import 'package:gamepads_platform_interface/api/gamepad_event.dart';
+import 'package:gamepads_platform_interface/api/gamepad_history.dart';
+import 'package:gamepads_platform_interface/api/gamepad_pattern.dart';
+import 'package:gamepads_platform_interface/api/gamepad_snapshot.dart';
 import 'package:gamepads_platform_interface/gamepads_platform_interface.dart';
 
 class Gamepads {
@@ -13,7 +16,39 @@ class Gamepads {
 
   static Stream<GamepadEvent> get events => _platform.gamepadEventsStream;
 
-  static Stream<GamepadEvent> eventsByGamepad(String gamepadId) {
-    return events.where((event) => event.gamepadId == gamepadId);
-  }
+  /// The events of a single gamepad.
+  ///
+  /// On Linux, gamepads are only read while something listens to their
+  /// events (here or through [events]) or patterns are registered.
+  static Stream<GamepadEvent> eventsByGamepad(String gamepadId) =>
+      _platform.eventsByGamepad(gamepadId);
+
+  /// The whole state of gamepads when they are connected or opened again,
+  /// sent at once instead of as [events].
+  ///
+  /// Currently only supported on Linux.
+  static Stream<GamepadSnapshot> get snapshots =>
+      _platform.gamepadSnapshotsStream;
+
+  /// Registers a chord or sequence to be detected by the platform, reporting
+  /// matches on [patternMatches].
+  ///
+  /// Currently only supported on Linux.
+  static Future<void> registerPattern(GamepadPattern pattern) =>
+      _platform.registerPattern(pattern);
+
+  static Future<void> unregisterPattern(String patternId) =>
+      _platform.unregisterPattern(patternId);
+
+  /// Returns the inputs of a gamepad since the given timestamp (or all of
+  /// them, by default), as kept by the platform, e.g. to resimulate them.
+  ///
+  /// Currently only supported on Linux.
+  static Future<GamepadHistory> getHistory(
+    String gamepadId, {
+    int since = 0,
+  }) => _platform.getHistory(gamepadId, since: since);
+
+  static Stream<GamepadPatternMatch> get patternMatches =>
+      _platform.patternMatchesStream;
 }
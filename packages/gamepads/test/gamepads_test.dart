@@ -1,3 +1,5 @@
+import 'dart:typed_data';
+
 import 'package:flutter/services.dart';
 import 'package:flutter_test/flutter_test.dart';
 
@@ -15,6 +17,13 @@ void main() {
         channel,
         (MethodCall methodCall) async {
           calls.add(methodCall);
+          if (methodCall.method == 'getHistory') {
+            // A button press at 100 followed by an axis move at 120.
+            return Uint8List.fromList([
+              100, 0, 0, 0, 1, 0, 0x01, 3, //
+              120, 0, 0, 0, 0x00, 0x80, 0x02, 1, //
+            ]);
+          }
           return <GamepadController>[];
         },
       );
@@ -64,6 +73,27 @@ void main() {
     expect(event.type, KeyType.button);
     expect(event.key, 'a');
     expect(event.value, 1.0);
+    expect(event.standardKey, isNull);
+  });
+
+  test('parses the standard key of events', () async {
+    final listener = Gamepads.events.first;
+    await platformInterface.platformCallHandler(
+      const MethodCall(
+        'onGamepadEvent',
+        <String, dynamic>{
+          'gamepadId': '1',
+          'time': 0,
+          'type': 'button',
+          'key': '2',
+          'value': 1.0,
+          'standardKey': 'north',
+        },
+      ),
+    );
+    final event = await listener;
+    expect(event.key, '2');
+    expect(event.standardKey, 'north');
   });
 
   test(
@@ -91,4 +121,174 @@ void main() {
       expect(event.value, 1.0);
     },
   );
+
+  test('subscribes to the events of a single gamepad', () async {
+    final subscription = Gamepads.eventsByGamepad('2').listen((_) {});
+    await Future<void>.delayed(Duration.zero);
+    expect(popLastCall().arguments, <String, dynamic>{
+      'enabled': true,
+      'gamepadId': '2',
+    });
+    await subscription.cancel();
+    await Future<void>.delayed(Duration.zero);
+    expect(popLastCall().arguments, <String, dynamic>{
+      'enabled': false,
+      'gamepadId': '2',
+    });
+  });
+
+  test('registers patterns through platform interface', () async {
+    await Gamepads.registerPattern(
+      const GamepadChord(
+        id: 'menu',
+        keys: ['6', '7'],
+        tolerance: Duration(milliseconds: 150),
+      ),
+    );
+    final call = popLastCall();
+    expect(call.method, 'registerPattern');
+    expect(call.arguments, <String, dynamic>{
+      'id': 'menu',
+      'type': 'chord',
+      'buttons': ['6', '7'],
+      'windowMs': 150,
+    });
+  });
+
+  test('can listen to pattern matches through platform interface', () async {
+    final listener = Gamepads.patternMatches.first;
+    await platformInterface.platformCallHandler(
+      const MethodCall(
+        'onPatternMatched',
+        <String, dynamic>{
+          'gamepadId': '1',
+          'patternId': 'menu',
+          'time': 42,
+        },
+      ),
+    );
+    final match = await listener;
+    expect(match.gamepadId, '1');
+    expect(match.patternId, 'menu');
+    expect(match.timestamp, 42);
+  });
+
+  test('seeds the state of gamepads from snapshots', () async {
+    final controller = GamepadController.parse(
+      <String, dynamic>{
+        'id': '1',
+        'name': 'Pad',
+        'buttons': Int32List.fromList([1, 0]),
+        'axes': Int32List.fromList([-7]),
+      },
+      platformInterface,
+    );
+    expect(controller.state.buttonInputs, {'0': true, '1': false});
+    expect(controller.state.analogInputs, {'0': -7.0});
+
+    final listener = Gamepads.snapshots.first;
+    await platformInterface.platformCallHandler(
+      MethodCall(
+        'onGamepadSnapshot',
+        <String, dynamic>{
+          'gamepadId': '1',
+          'name': 'Pad',
+          'connected': false,
+          'buttons': Int32List.fromList([0]),
+          'axes': Int32List.fromList([0, 32767]),
+        },
+      ),
+    );
+    final snapshot = await listener;
+    expect(snapshot.gamepadId, '1');
+    expect(snapshot.isConnection, isFalse);
+    expect(controller.state.buttonInputs, {'0': false});
+    expect(controller.state.analogInputs, {'0': 0.0, '1': 32767.0});
+    await controller.dispose();
+    await Future<void>.delayed(Duration.zero);
+  });
+
+  test('orders snapshots and events by their sequence numbers', () async {
+    Future<void> send(String method, Map<String, dynamic> args) async {
+      await platformInterface.platformCallHandler(MethodCall(method, args));
+      // Let the controller receive it.
+      await Future<void>.delayed(Duration.zero);
+    }
+
+    Future<void> sendEvent({required int sequence, required double value}) {
+      return send('onGamepadEvent', <String, dynamic>{
+        'gamepadId': '1',
+        'time': 0,
+        'type': 'button',
+        'key': '0',
+        'value': value,
+        'sequence': sequence,
+      });
+    }
+
+    Future<void> sendSnapshot({required int sequence, required int button}) {
+      return send('onGamepadSnapshot', <String, dynamic>{
+        'gamepadId': '1',
+        'name': 'Pad',
+        'connected': false,
+        'buttons': Int32List.fromList([button]),
+        'axes': Int32List.fromList([]),
+        'sequence': sequence,
+      });
+    }
+
+    // Listed after the button was pressed by event 10.
+    final controller = GamepadController.parse(
+      <String, dynamic>{
+        'id': '1',
+        'name': 'Pad',
+        'buttons': Int32List.fromList([1]),
+        'axes': Int32List.fromList([]),
+        'sequence': 10,
+      },
+      platformInterface,
+    );
+
+    await sendEvent(sequence: 9, value: 0);
+    expect(
+      controller.state.buttonInputs,
+      {'0': true},
+      reason: 'an event included in the snapshot was applied again',
+    );
+    await sendEvent(sequence: 10, value: 1);
+    await sendEvent(sequence: 11, value: 0);
+    expect(controller.state.buttonInputs, {'0': false});
+
+    await sendSnapshot(sequence: 10, button: 1);
+    expect(
+      controller.state.buttonInputs,
+      {'0': false},
+      reason: 'a snapshot older than the last event was applied',
+    );
+    await sendSnapshot(sequence: 11, button: 0);
+    await sendEvent(sequence: 12, value: 1);
+    expect(controller.state.buttonInputs, {'0': true});
+
+    await controller.dispose();
+  });
+
+  test('reads the packed history through platform interface', () async {
+    final history = await Gamepads.getHistory('1', since: 100);
+    final call = popLastCall();
+    expect(call.method, 'getHistory');
+    expect(call.arguments, <String, dynamic>{'gamepadId': '1', 'since': 100});
+
+    expect(history.length, 2);
+    expect(history.timestampAt(0), 100);
+    expect(history.typeAt(0), KeyType.button);
+    expect(history.keyAt(0), 3);
+    expect(history.valueAt(0), 1.0);
+    expect(history.valueAt(1), -32768.0);
+    expect(history.typeAt(1), KeyType.analog);
+
+    final event = history.eventAt(1);
+    expect(event.gamepadId, '1');
+    expect(event.timestamp, 120);
+    expect(event.key, '1');
+  });
 }
@@ -0,0 +1,159 @@
+import 'dart:ffi';
+import 'dart:isolate';
+import 'dart:typed_data';
+
+import 'package:flutter/foundation.dart' show visibleForTesting;
+import 'package:gamepads_platform_interface/api/gamepad_event.dart';
+import 'package:gamepads_platform_interface/api/gamepad_history.dart';
+import 'package:gamepads_platform_interface/gamepads_platform_interface.dart';
+import 'package:gamepads_platform_interface/method_channel_gamepads_platform_interface.dart';
+
+typedef _OpenPortNative =
+    Int64 Function(Int64 port, Pointer<Void> postCObject);
+typedef _OpenPort = int Function(int port, Pointer<Void> postCObject);
+typedef _ClosePortNative = Void Function(Int64 handle);
+typedef _ClosePort = void Function(int handle);
+
+/// The standard keys, in the order of the indices sent by the native side
+/// (`mappings::button_names` followed by `mappings::axis_names`).
+const _standardKeys = [
+  'south',
+  'east',
+  'west',
+  'north',
+  'leftShoulder',
+  'rightShoulder',
+  'back',
+  'start',
+  'guide',
+  'leftStick',
+  'rightStick',
+  'leftX',
+  'leftY',
+  'rightX',
+  'rightY',
+  'leftTrigger',
+  'rightTrigger',
+  'dpadX',
+  'dpadY',
+];
+
+class _NativePorts {
+  final _OpenPort open;
+  final _ClosePort close;
+
+  _NativePorts(this.open, this.close);
+
+  /// Looks up the native entry points, returning null if the plugin was built
+  /// without them.
+  static _NativePorts? lookup() {
+    try {
+      final library = DynamicLibrary.open('libgamepads_linux_plugin.so');
+      return _NativePorts(
+        library.lookupFunction<_OpenPortNative, _OpenPort>(
+          'gamepads_linux_open_port',
+        ),
+        library.lookupFunction<_ClosePortNative, _ClosePort>(
+          'gamepads_linux_close_port',
+        ),
+      );
+    } on ArgumentError {
+      return null;
+    }
+  }
+}
+
+/// The Linux implementation of [GamepadsPlatformInterface].
+///
+/// Events are posted by the native readers straight to a [ReceivePort], in
+/// batches, instead of going through the method channel one by one. It falls
+/// back to the method channel when native ports are not available.
+class GamepadsLinux extends MethodChannelGamepadsPlatformInterface {
+  static void registerWith() {
+    GamepadsPlatformInterface.instance = GamepadsLinux();
+  }
+
+  final _NativePorts? _nativePorts = _NativePorts.lookup();
+  ReceivePort? _receivePort;
+  int? _handle;
+
+  /// Opens the port events are posted to, returning its native handle or null
+  /// if native ports are not available.
+  int? _openPort() {
+    if (_handle != null || _nativePorts == null) {
+      return _handle;
+    }
+    final receivePort = ReceivePort();
+    final handle = _nativePorts.open(
+      receivePort.sendPort.nativePort,
+      NativeApi.postCObject.cast(),
+    );
+    if (handle < 0) {
+      receivePort.close();
+      return null;
+    }
+    _receivePort = receivePort..listen(onBatch);
+    return _handle = handle;
+  }
+
+  @override
+  Future<void> setEventsEnabled({
+    required bool enabled,
+    String? gamepadId,
+  }) async {
+    final handle = _openPort();
+    if (handle == null) {
+      return super.setEventsEnabled(enabled: enabled, gamepadId: gamepadId);
+    }
+    await channel.invokeMethod<void>('setEventsEnabled', <String, dynamic>{
+      'enabled': enabled,
+      'gamepadId': ?gamepadId,
+      'port': handle,
+    });
+  }
+
+  /// Emits the events of a batch: the gamepad id, the packed records followed
+  /// by the index of the standard key of each event, and the sequence number
+  /// of the first event.
+  @visibleForTesting
+  void onBatch(Object? message) {
+    final batch = message! as List<Object?>;
+    final gamepadId = batch[0]! as String;
+    final bytes = batch[1]! as Uint8List;
+    final firstSequence = batch[2]! as int;
+    final count = bytes.length ~/ (GamepadHistory.recordSize + 1);
+    final recordsLength = count * GamepadHistory.recordSize;
+    final records = GamepadHistory(
+      gamepadId,
+      Uint8List.sublistView(bytes, 0, recordsLength),
+    );
+    for (var i = 0; i < count; i++) {
+      final standardIndex = bytes[recordsLength + i];
+      emitGamepadEvent(
+        GamepadEvent(
+          gamepadId: gamepadId,
+          timestamp: records.timestampAt(i),
+          type: records.typeAt(i),
+          key: records.keyAt(i).toString(),
+          value: records.valueAt(i),
+          standardKey: standardIndex < _standardKeys.length
+              ? _standardKeys[standardIndex]
+              : null,
+          sequence: firstSequence + i,
+        ),
+      );
+    }
+  }
+
+  @override
+  Future<void> dispose() async {
+    final handle = _handle;
+    if (handle != null) {
+      _nativePorts!.close(handle);
+      _handle = null;
+    }
+    _receivePort?.close();
+    _receivePort = null;
+    await super.dispose();
+  }
+}
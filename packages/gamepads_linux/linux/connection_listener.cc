@@ -5,16 +5,19 @@
 #include <string>
 
 #include <dirent.h>
+#include <poll.h>
 #include <sys/inotify.h>
+#include <sys/stat.h>
+#include <cstring>
 #include <map>
+#include <vector>
 
 #include "connection_listener.h"
+#include "trace.h"
 #include "utils.h"
 
 using namespace connection_listener;
 
-const std::string _input_dir = "/dev/input/";
-
 std::map<ConnectionEventType, const char*> connectionEventTypeNames = {
     {ConnectionEventType::CONNECTED, "CONNECTED"},
     {ConnectionEventType::DISCONNECTED, "DISCONNECTED"},
@@ -31,25 +34,42 @@ std::optional<ConnectionEventType> _parseEventType(inotify_event* event) {
   }
 }
 
+/**
+ * Finds the type of the node at [path], as in `dirent::d_type`, for the nodes
+ * created after listing the directory and the filesystems that don't report
+ * it while listing.
+ */
+static unsigned char _node_type(const std::string& path) {
+  struct stat status;
+  if (lstat(path.c_str(), &status) != 0) {
+    return DT_UNKNOWN;
+  }
+  return IFTODT(status.st_mode);
+}
+
 void _list_existing(
+    const std::string& input_dir,
+    const NodeTypeFilter& is_node_type,
     const std::function<void(const ConnectionEvent&)>& event_consumer) {
-  DIR* dir = opendir(_input_dir.c_str());
+  DIR* dir = opendir(input_dir.c_str());
 
   if (!dir) {
-    std::cerr << "Failed to open directory: " << _input_dir << std::endl;
+    std::cerr << "Failed to open directory: " << input_dir << std::endl;
     throw std::runtime_error("Error reading existing connections");
   }
 
   struct dirent* entry;
   std::vector<std::string> devices;
   while ((entry = readdir(dir)) != nullptr) {
-    if (entry->d_type != DT_CHR) {
+    if (!starts_with(entry->d_name, "js")) {
       continue;
     }
-    if (!starts_with(entry->d_name, "js")) {
+    std::string device = input_dir + entry->d_name;
+    unsigned char type =
+        entry->d_type == DT_UNKNOWN ? _node_type(device) : entry->d_type;
+    if (!is_node_type(type)) {
       continue;
     }
-    std::string device = _input_dir + entry->d_name;
     devices.push_back(device);
   }
 
@@ -62,11 +82,16 @@ void _list_existing(
 }
 
 void _wait_for_connections(
+    const std::string& input_dir,
+    const NodeTypeFilter& is_node_type,
     int inotify,
     const std::function<void(const ConnectionEvent&)>& event_consumer) {
   char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
   ssize_t len = read(inotify, buffer, sizeof(buffer));
   if (len < 0) {
+    if (errno == EINTR || errno == EAGAIN) {
+      return;
+    }
     std::cerr << "Error reading inotify events" << std::endl;
     throw std::runtime_error("Error reading inotify events");
   }
@@ -74,45 +99,84 @@ void _wait_for_connections(
   char* ptr = buffer;
   while (ptr < buffer + len) {
     auto* event = reinterpret_cast<struct inotify_event*>(ptr);
-    std::string name = event->name;
+    ptr += sizeof(struct inotify_event) + event->len;
+
+    std::string name = event->len > 0 ? event->name : "";
     if (!starts_with(name, "js")) {
-      break;
+      continue;
     }
-
-    std::string device = _input_dir + name;
     std::optional<ConnectionEventType> type = _parseEventType(event);
+    if (!type) {
+      continue;
+    }
 
+    std::string device = input_dir + name;
+    if (*type == ConnectionEventType::CONNECTED &&
+        !is_node_type(_node_type(device))) {
+      continue;
+    }
     std::cout << "Connection found: " << connectionEventTypeNames[*type]
               << " - " << name << std::endl;
     ConnectionEvent connection_event = {*type, device};
     event_consumer(connection_event);
-
-    ptr += sizeof(struct inotify_event) + event->len;
   }
 }
 
 namespace connection_listener {
-void listen(const bool* keep_reading,
-            const std::function<void(const ConnectionEvent&)>& event_consumer) {
-  std::cout << "Reading initial gamepads..." << std::endl;
-  _list_existing(event_consumer);
+bool is_character_device(unsigned char type) {
+  return type == DT_CHR;
+}
+
+bool is_fifo(unsigned char type) {
+  return type == DT_FIFO;
+}
 
-  int inotify = inotify_init();
+void listen(const std::string& input_dir,
+            const NodeTypeFilter& is_node_type,
+            const std::atomic<bool>* keep_reading,
+            int wake_fd,
+            const std::function<void(const ConnectionEvent&)>& event_consumer) {
+  trace::set_thread_name("gamepad connections");
+  int inotify = inotify_init1(IN_CLOEXEC);
   if (inotify == -1) {
     std::cerr << "Error initializing inotify" << std::endl;
     throw std::runtime_error("Error initializing inotify");
   }
-  int watcher = inotify_add_watch(inotify, _input_dir.c_str(),
+  // Watch before listing, so devices connected in between are not missed.
+  int watcher = inotify_add_watch(inotify, input_dir.c_str(),
                                   IN_CREATE | IN_DELETE | IN_ATTRIB);
   if (watcher == -1) {
     close(inotify);
-    std::cerr << "Error adding watch for " << _input_dir << std::endl;
+    std::cerr << "Error adding watch for " << input_dir << std::endl;
     throw std::runtime_error("Error adding inotify watch");
   }
 
-  std::cout << "Listening for gamepads..." << std::endl;
-  while (*keep_reading) {
-    _wait_for_connections(inotify, event_consumer);
+  try {
+    std::cout << "Reading initial gamepads..." << std::endl;
+    _list_existing(input_dir, is_node_type, event_consumer);
+
+    std::cout << "Listening for gamepads..." << std::endl;
+    struct pollfd poll_fds[] = {
+        {inotify, POLLIN, 0},
+        {wake_fd, POLLIN, 0},
+    };
+    while (*keep_reading) {
+      if (poll(poll_fds, 2, -1) < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        std::cerr << "Error polling inotify: " << strerror(errno) << std::endl;
+        break;
+      }
+      if (poll_fds[1].revents != 0) {
+        break;
+      }
+      _wait_for_connections(input_dir, is_node_type, inotify, event_consumer);
+    }
+  } catch (...) {
+    inotify_rm_watch(inotify, watcher);
+    close(inotify);
+    throw;
   }
   std::cout << "Stopped listening for gamepads." << std::endl;
 
@@ -1,5 +1,9 @@
+#ifndef GAMEPADS_LINUX_CONNECTION_LISTENER_H_
+#define GAMEPADS_LINUX_CONNECTION_LISTENER_H_
+
 #include <sys/inotify.h>
 #include <unistd.h>
+#include <atomic>
 #include <functional>
 #include <iostream>
 #include <optional>
@@ -18,6 +22,26 @@ struct ConnectionEvent {
   std::string device_id;
 };
 
-void listen(const bool* keep_reading,
+// Tells whether a directory entry of the given `d_type` can be a joystick.
+using NodeTypeFilter = std::function<bool(unsigned char type)>;
+
+// Only accepts character devices, which joystick nodes are.
+bool is_character_device(unsigned char type);
+
+// Only accepts FIFOs, used as fake joysticks by tests and benchmarks.
+bool is_fifo(unsigned char type);
+
+/**
+ * Reports the joystick nodes already present in [input_dir] and then watches
+ * it for connections, until [keep_reading] is cleared and [wake_fd] becomes
+ * readable. Only nodes of a type accepted by [is_node_type] are reported as
+ * connected, whether they were listed or created later.
+ */
+void listen(const std::string& input_dir,
+            const NodeTypeFilter& is_node_type,
+            const std::atomic<bool>* keep_reading,
+            int wake_fd,
             const std::function<void(const ConnectionEvent&)>& event_consumer);
-}  // namespace connection_listener
\ No newline at end of file
+}  // namespace connection_listener
+
+#endif  // GAMEPADS_LINUX_CONNECTION_LISTENER_H_
@@ -1,44 +1,150 @@
 #include <fcntl.h>
 #include <linux/joystick.h>
+#include <poll.h>
 #include <unistd.h>
 #include <cstdio>
 
+#include <atomic>
 #include <cstring>
+#include <fstream>
 #include <functional>
 #include <iostream>
 #include <string>
+#include <vector>
 
 #include "gamepad.h"
+#include "latency_stats.h"
+#include "trace.h"
 #include "utils.h"
 
 using namespace gamepad;
 
 /**
- * Reads a joystick event from the joystick gamepad_id.
+ * Reads as many pending joystick events as fit in the buffer.
  *
- * Returns 0 on success. Otherwise -1 is returned.
+ * Returns the number of events read (possibly none, for non-blocking devices),
+ * or -1 if the device can no longer be read from.
  */
-static int read_event(int fd, struct js_event* event) {
+static ssize_t read_events(int fd, struct js_event* events, size_t capacity) {
   ssize_t bytes;
+  do {
+    bytes = read(fd, events, capacity * sizeof(*events));
+  } while (bytes < 0 && errno == EINTR);
 
-  bytes = read(fd, event, sizeof(*event));
+  if (bytes < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+    return 0;
+  }
+  if (bytes <= 0) {
+    /* Error, the device is gone or could not be read. */
+    return -1;
+  }
+  return bytes / static_cast<ssize_t>(sizeof(*events));
+}
+
+/**
+ * Busy-polls the device for up to [window_us] microseconds.
+ *
+ * Returns true as soon as an event is ready to be read.
+ */
+static bool busy_poll(int fd, int window_us) {
+  uint64_t deadline =
+      latency_stats::now_ns() + static_cast<uint64_t>(window_us) * 1000;
+  struct pollfd poll_fd = {fd, POLLIN, 0};
+  do {
+    if (poll(&poll_fd, 1, 0) != 0) {
+      return true;
+    }
+  } while (latency_stats::now_ns() < deadline);
+  return false;
+}
 
-  if (bytes == sizeof(*event)) {
+/**
+ * Reads one of the hexadecimal ids (vendor, product, version) that the
+ * kernel exposes for the input device behind the joystick node.
+ *
+ * Returns 0 if the id is not available.
+ */
+static uint16_t read_hardware_id(const std::string& device_id,
+                                 const char* field) {
+  std::string node = device_id.substr(device_id.find_last_of('/') + 1);
+  std::ifstream file("/sys/class/input/" + node + "/device/id/" + field);
+  unsigned int value = 0;
+  if (!(file >> std::hex >> value)) {
     return 0;
   }
+  return static_cast<uint16_t>(value);
+}
+
+// Last sequence number given to an event, shared by all gamepads.
+static std::atomic<uint64_t> _last_sequence = 0;
+
+/**
+ * Applies the events read from the gamepad to its snapshot, then passes the
+ * initial state replayed after opening the device to the [on_snapshot]
+ * callback and the live events to the others.
+ */
+static void deliver(GamepadInfo* gamepad,
+                    const js_event* events,
+                    size_t count,
+                    const ReadCallbacks& callbacks) {
+  if (count == 0) {
+    return;
+  }
+  // The kernel replays the whole initial state before any live event.
+  size_t initial = 0;
+  while (initial < count && (events[initial].type & JS_EVENT_INIT)) {
+    initial++;
+  }
+  uint64_t first_sequence = _last_sequence.fetch_add(count) + 1;
+  {
+    std::lock_guard<std::mutex> lock(gamepad->snapshot_mutex);
+    for (size_t i = 0; i < count; i++) {
+      gamepad->snapshot.apply(events[i], first_sequence + i);
+    }
+  }
+  if (initial > 0 && callbacks.on_snapshot) {
+    callbacks.on_snapshot(events, initial);
+  }
 
-  /* Error, could not read full event. */
-  return -1;
+  const js_event* live = events + initial;
+  size_t live_count = count - initial;
+  uint64_t live_sequence = first_sequence + initial;
+  uint64_t read_ns = latency_stats::now_ns();
+  for (size_t i = 0; i < live_count; i++) {
+    callbacks.on_event(live[i], live_sequence + i);
+    uint64_t emit_ns = latency_stats::now_ns();
+    latency_stats::record(read_ns, emit_ns);
+    latency_stats::record_since_kernel(live[i].time, emit_ns);
+  }
+  if (callbacks.on_batch && live_count > 0) {
+    callbacks.on_batch(live, live_count, live_sequence);
+  }
 }
 
 namespace gamepad {
-std::optional<GamepadInfo> get_gamepad_info(const std::string& device_id) {
+void Snapshot::apply(const js_event& event, uint64_t event_sequence) {
+  std::vector<int16_t>& values =
+      (event.type & ~JS_EVENT_INIT) == JS_EVENT_BUTTON ? buttons : axes;
+  if (event.number >= values.size()) {
+    values.resize(event.number + 1);
+  }
+  values[event.number] = event.value;
+  sequence = event_sequence;
+}
+
+int open_device(const std::string& device_id) {
+  return open(device_id.c_str(), O_RDONLY | O_CLOEXEC);
+}
+
+std::unique_ptr<GamepadInfo> get_gamepad_info(const std::string& device_id,
+                                              const DeviceOpener& opener) {
   std::cout << "Listening to gamepad " << device_id << std::endl;
 
-  int file_descriptor = open(device_id.c_str(), O_RDONLY);
+  int file_descriptor = opener(device_id);
   if (file_descriptor == -1) {
-    std::cerr << "Could not open joystick: " << file_descriptor << std::endl;
-    return std::nullopt;
+    std::cerr << "Could not open joystick " << device_id << ": "
+              << strerror(errno) << std::endl;
+    return nullptr;
   }
 
   char name[128];
@@ -47,20 +153,103 @@ std::optional<GamepadInfo> get_gamepad_info(const std::string& device_id) {
               << std::endl;
     strcpy(name, "Unknown");
   }
+  uint8_t buttons = 0;
+  uint8_t axes = 0;
+  if (ioctl(file_descriptor, JSIOCGBUTTONS, &buttons) < 0 ||
+      ioctl(file_descriptor, JSIOCGAXES, &axes) < 0) {
+    buttons = 0;
+    axes = 0;
+  }
 
-  return {{device_id, name, file_descriptor, true}};
+  auto info = std::make_unique<GamepadInfo>();
+  info->device_id = device_id;
+  info->name = name;
+  info->file_descriptor = file_descriptor;
+  info->alive = true;
+  info->hardware_id = {
+      read_hardware_id(device_id, "vendor"),
+      read_hardware_id(device_id, "product"),
+      read_hardware_id(device_id, "version"),
+  };
+  info->mapping = mappings::find(info->hardware_id);
+  if (info->mapping) {
+    std::cout << "Using standard mapping for " << info->mapping->name
+              << std::endl;
+  }
+  info->snapshot.buttons.resize(buttons);
+  info->snapshot.axes.resize(axes);
+  return info;
+}
+
+void read_initial_state(GamepadInfo* gamepad, const ReadCallbacks& callbacks) {
+  size_t expected = gamepad->snapshot.buttons.size() +
+                    gamepad->snapshot.axes.size();
+  struct pollfd poll_fd = {gamepad->file_descriptor, POLLIN, 0};
+  std::vector<js_event> events;
+  while (events.size() < expected) {
+    js_event event;
+    if (poll(&poll_fd, 1, 0) <= 0 ||
+        read(gamepad->file_descriptor, &event, sizeof(event)) !=
+            sizeof(event)) {
+      break;
+    }
+    events.push_back(event);
+    if (!(event.type & JS_EVENT_INIT)) {
+      break;
+    }
+  }
+  deliver(gamepad, events.data(), events.size(), callbacks);
 }
 
 void listen(GamepadInfo* gamepad,
-            const std::function<void(const js_event&)>& event_consumer) {
+            int wake_fd,
+            const low_latency::Config& config,
+            const ReadCallbacks& callbacks) {
   std::cout << "Listening to gamepad " << gamepad->device_id << std::endl;
 
+  low_latency::apply_to_current_thread(config);
+  trace::set_thread_name("gamepad " + gamepad->device_id);
+  struct js_event events[max_batch_events];
+  low_latency::lock_memory(config, events, sizeof(events));
+
+  struct pollfd poll_fds[] = {
+      {gamepad->file_descriptor, POLLIN, 0},
+      {wake_fd, POLLIN, 0},
+  };
   while (gamepad->alive) {
-    struct js_event event;
-    read_event(gamepad->file_descriptor, &event);
-    event_consumer(event);
+    if (poll(poll_fds, 2, -1) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      std::cerr << "Failed to poll gamepad " << gamepad->device_id << ": "
+                << strerror(errno) << std::endl;
+      gamepad->alive = false;
+      break;
+    }
+    if (poll_fds[1].revents != 0) {
+      break;
+    }
+
+    ssize_t count;
+    {
+      trace::Span span("read");
+      count = read_events(gamepad->file_descriptor, events, max_batch_events);
+    }
+    if (count < 0) {
+      std::cerr << "Failed to read from gamepad " << gamepad->device_id
+                << std::endl;
+      gamepad->alive = false;
+      break;
+    }
+
+    deliver(gamepad, events, static_cast<size_t>(count), callbacks);
+
+    if (config.enabled && config.busy_poll_us > 0) {
+      busy_poll(gamepad->file_descriptor, config.busy_poll_us);
+    }
   }
 
+  low_latency::unlock_memory(config, events, sizeof(events));
   std::cout << "Stopped listening for events: " << gamepad->device_id
             << std::endl;
   close(gamepad->file_descriptor);
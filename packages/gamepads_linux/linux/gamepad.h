@@ -1,23 +1,103 @@
+#ifndef GAMEPADS_LINUX_GAMEPAD_H_
+#define GAMEPADS_LINUX_GAMEPAD_H_
+
 #include <fcntl.h>
 #include <linux/joystick.h>
 #include <unistd.h>
 
+#include <atomic>
 #include <functional>
-#include <optional>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
+#include "history.h"
+#include "low_latency.h"
+#include "mappings.h"
+#include "patterns.h"
 #include "utils.h"
 
 namespace gamepad {
+// Opens a device node for reading, returning -1 on failure.
+using DeviceOpener = std::function<int(const std::string& device_id)>;
+
+/**
+ * The state of every input of a gamepad, as replayed by the kernel with
+ * `JS_EVENT_INIT` events whenever the device is opened, then kept up to date
+ * with every event read.
+ */
+struct Snapshot {
+  std::vector<int16_t> buttons;
+  std::vector<int16_t> axes;
+  // Sequence number of the last event applied, see [ReadCallbacks::on_event].
+  uint64_t sequence = 0;
+
+  // Records the value of an event with the given sequence number.
+  void apply(const js_event& event, uint64_t event_sequence);
+};
+
 struct GamepadInfo {
   std::string device_id;
   std::string name;
   int file_descriptor;
-  bool alive;
+  std::atomic<bool> alive;
+  patterns::Matcher matcher;
+  mappings::DeviceId hardware_id;
+  // Standard layout of the gamepad, or nullptr if it's not a known model.
+  const mappings::Mapping* mapping;
+  // Most recent events, kept for rollback; see [history::Config].
+  history::Ring history;
+  // Written by the reader thread; guarded by [snapshot_mutex].
+  Snapshot snapshot;
+  mutable std::mutex snapshot_mutex;
 };
 
-std::optional<GamepadInfo> get_gamepad_info(const std::string& device);
+// Largest number of events fetched from the device with a single read, and so
+// passed at once to [ReadCallbacks::on_batch].
+constexpr size_t max_batch_events = 64;
 
+struct ReadCallbacks {
+  // Called for every event, except for the initial state which is folded
+  // into the gamepad's snapshot instead. Every event read is numbered, across
+  // all gamepads, so that it can be ordered against snapshots; it is already
+  // applied to the snapshot when this is called.
+  std::function<void(const js_event& event, uint64_t sequence)> on_event;
+  // Called once per read with all the events passed to [on_event], which are
+  // numbered consecutively from [first_sequence].
+  std::function<void(const js_event* events,
+                     size_t count,
+                     uint64_t first_sequence)>
+      on_batch;
+  // Called with the initial state events once they were folded into the
+  // snapshot.
+  std::function<void(const js_event* events, size_t count)> on_snapshot;
+};
+
+// Opens the device with `open(2)`, in blocking read-only mode.
+int open_device(const std::string& device_id);
+
+/**
+ * Opens the device and reads its name and ids, leaving it open.
+ */
+std::unique_ptr<GamepadInfo> get_gamepad_info(const std::string& device,
+                                              const DeviceOpener& opener);
+
+/**
+ * Folds the initial state that the kernel replays when a device is opened
+ * into the gamepad's snapshot, without blocking. A live event read along with
+ * it is passed to the callbacks like [listen] does, as it can't be put back.
+ */
+void read_initial_state(GamepadInfo* gamepad, const ReadCallbacks& callbacks);
+
+/**
+ * Reads events from the gamepad until it is disconnected or [wake_fd] becomes
+ * readable, closing the gamepad's file descriptor before returning.
+ */
 void listen(GamepadInfo* gamepad,
-            const std::function<void(const js_event&)>& event_consumer);
-}  // namespace gamepad
\ No newline at end of file
+            int wake_fd,
+            const low_latency::Config& config,
+            const ReadCallbacks& callbacks);
+}  // namespace gamepad
+
+#endif  // GAMEPADS_LINUX_GAMEPAD_H_
@@ -2,31 +2,79 @@
 
 #include <flutter_linux/flutter_linux.h>
 
+#include <atomic>
+#include <cctype>
+#include <cstdio>
 #include <iostream>
-#include <map>
+#include <memory>
+#include <mutex>
 #include <optional>
-#include <sstream>
-#include <thread>
+#include <string>
+#include <utility>
+#include <vector>
 
-#include "connection_listener.h"
 #include "gamepad.h"
+#include "input_core.h"
+#include "latency_stats.h"
+#include "mappings.h"
+#include "native_port.h"
+#include "patterns.h"
+#include "trace.h"
 
 #define GAMEPADS_LINUX_PLUGIN(obj)                                     \
   (G_TYPE_CHECK_INSTANCE_CAST((obj), gamepads_linux_plugin_get_type(), \
                               GamepadsLinuxPlugin))
 
+// Messages the queue has room for before it needs to grow.
+static constexpr size_t _queue_capacity = 256;
+
+/**
+ * A message produced on a reader thread, waiting for the main loop.
+ *
+ * Events are kept as plain values in slots reused between drains, and only
+ * encoded on the main loop, so queueing them doesn't allocate.
+ */
+struct PendingMessage {
+  const char* method;
+  // The arguments of any message other than an event, or nullptr.
+  FlValue* args;
+  std::string gamepad_id;
+  js_event event;
+  uint64_t sequence;
+  const char* standard_key;
+};
+
+/**
+ * State of a plugin instance (one per Flutter engine).
+ *
+ * All instances share the same input core, so every device is read only
+ * once no matter how many engines are running.
+ */
+struct PluginState {
+  std::shared_ptr<input_core::InputCore> core;
+  // Raw events are only sent for the gamepads the Dart side subscribes to.
+  input_core::ListenerId listener_id = 0;
+
+  // Messages produced on the reader threads, waiting for the main loop. Only
+  // the first [queue_size] slots are in use; the drained messages are kept in
+  // [drained_queue], so its storage is reused by the next drain.
+  std::mutex queue_mutex;
+  std::vector<PendingMessage> queue;
+  size_t queue_size = 0;
+  std::vector<PendingMessage> drained_queue;
+  bool drain_scheduled = false;
+};
+
 struct _GamepadsLinuxPlugin {
   GObject parent_instance;
+
+  FlMethodChannel* channel;
+  PluginState* state;
 };
 
 G_DEFINE_TYPE(GamepadsLinuxPlugin, gamepads_linux_plugin, g_object_get_type())
 
-static FlMethodChannel* channel;
-
-bool keep_reading_events = false;
-std::map<std::string, gamepad::GamepadInfo> gamepads = {};
-
-static std::string parse_event_type(js_event event) {
+static const char* parse_event_type(js_event event) {
   switch (event.type & ~JS_EVENT_INIT) {
     case JS_EVENT_BUTTON: {
       return "button";
@@ -41,21 +89,222 @@ static std::string parse_event_type(js_event event) {
   }
 }
 
-static void emit_gamepad_event(gamepad::GamepadInfo* gamepad,
-                               const js_event& event) {
-  if (channel) {
-    g_autoptr(FlValue) map = fl_value_new_map();
-    fl_value_set_string(map, "gamepadId",
-                        fl_value_new_string(gamepad->device_id.c_str()));
-    fl_value_set_string(map, "time", fl_value_new_int(event.time));
-    fl_value_set_string(map, "type",
-                        fl_value_new_string(parse_event_type(event).c_str()));
-    fl_value_set_string(
-        map, "key", fl_value_new_string(std::to_string(event.number).c_str()));
-    fl_value_set_string(map, "value", fl_value_new_float(event.value));
-    fl_method_channel_invoke_method(channel, "onGamepadEvent", map, nullptr,
-                                    nullptr, nullptr);
+static FlValue* encode_event(const PendingMessage& message) {
+  trace::Span span("encode");
+  const js_event& event = message.event;
+  char key[8];
+  snprintf(key, sizeof(key), "%u", event.number);
+
+  FlValue* map = fl_value_new_map();
+  fl_value_set_string_take(map, "gamepadId",
+                           fl_value_new_string(message.gamepad_id.c_str()));
+  fl_value_set_string_take(map, "time", fl_value_new_int(event.time));
+  fl_value_set_string_take(map, "type",
+                           fl_value_new_string(parse_event_type(event)));
+  fl_value_set_string_take(map, "key", fl_value_new_string(key));
+  fl_value_set_string_take(map, "value", fl_value_new_float(event.value));
+  fl_value_set_string_take(map, "sequence",
+                           fl_value_new_int(message.sequence));
+  if (message.standard_key) {
+    fl_value_set_string_take(map, "standardKey",
+                             fl_value_new_string(message.standard_key));
   }
+  return map;
+}
+
+/**
+ * Sends all the queued messages through the channel, on the main loop.
+ */
+static gboolean drain_queue(gpointer user_data) {
+  GamepadsLinuxPlugin* self = GAMEPADS_LINUX_PLUGIN(user_data);
+  if (!self->state) {
+    return G_SOURCE_REMOVE;
+  }
+
+  trace::Span span("drain");
+  PluginState* state = self->state;
+  size_t count;
+  {
+    std::lock_guard<std::mutex> lock(state->queue_mutex);
+    state->queue.swap(state->drained_queue);
+    count = state->queue_size;
+    state->queue_size = 0;
+    state->drain_scheduled = false;
+  }
+  for (size_t i = 0; i < count; i++) {
+    PendingMessage& message = state->drained_queue[i];
+    FlValue* args = message.args ? message.args : encode_event(message);
+    message.args = nullptr;
+    if (self->channel) {
+      // Includes encoding the message with the standard codec.
+      trace::Span invoke_span("invoke_method");
+      fl_method_channel_invoke_method(self->channel, message.method, args,
+                                      nullptr, nullptr, nullptr);
+    }
+    fl_value_unref(args);
+  }
+  return G_SOURCE_REMOVE;
+}
+
+/**
+ * Reserves the next slot of the queue, scheduling a drain on the main loop
+ * if needed; [queue_mutex] must be held.
+ */
+static PendingMessage& next_slot(GamepadsLinuxPlugin* self) {
+  PluginState* state = self->state;
+  if (state->queue_size == state->queue.size()) {
+    state->queue.emplace_back();
+  }
+  if (!state->drain_scheduled) {
+    state->drain_scheduled = true;
+    g_idle_add_full(G_PRIORITY_HIGH, drain_queue, g_object_ref(self),
+                    g_object_unref);
+  }
+  return state->queue[state->queue_size++];
+}
+
+/**
+ * Queues a message to be sent from the main loop, as channels can't be used
+ * from the reader threads. Takes ownership of [args].
+ */
+static void enqueue_message(GamepadsLinuxPlugin* self,
+                            const char* method,
+                            FlValue* args) {
+  trace::Span span("enqueue");
+  std::lock_guard<std::mutex> lock(self->state->queue_mutex);
+  PendingMessage& message = next_slot(self);
+  message.method = method;
+  message.args = args;
+}
+
+static void emit_gamepad_event(GamepadsLinuxPlugin* self,
+                               gamepad::GamepadInfo* gamepad,
+                               const js_event& event,
+                               uint64_t sequence) {
+  const char* standard_key;
+  {
+    trace::Span span("decode");
+    standard_key = mappings::standard_key(gamepad->mapping, event);
+  }
+
+  trace::Span span("enqueue");
+  std::lock_guard<std::mutex> lock(self->state->queue_mutex);
+  PendingMessage& message = next_slot(self);
+  message.method = "onGamepadEvent";
+  message.args = nullptr;
+  // Reuses the slot's buffer once it was large enough.
+  message.gamepad_id.assign(gamepad->device_id);
+  message.event = event;
+  message.sequence = sequence;
+  message.standard_key = standard_key;
+}
+
+static void emit_pattern_matched(GamepadsLinuxPlugin* self,
+                                 gamepad::GamepadInfo* gamepad,
+                                 const patterns::Pattern& pattern,
+                                 const js_event& event) {
+  FlValue* map = fl_value_new_map();
+  fl_value_set_string(map, "gamepadId",
+                      fl_value_new_string(gamepad->device_id.c_str()));
+  fl_value_set_string(map, "patternId",
+                      fl_value_new_string(pattern.id.c_str()));
+  fl_value_set_string(map, "time", fl_value_new_int(event.time));
+  enqueue_message(self, "onPatternMatched", map);
+}
+
+/**
+ * Adds the current raw values of the gamepad's buttons and axes, indexed by
+ * their key, along with the sequence number of the last event they include.
+ */
+static void set_snapshot(FlValue* map, const gamepad::GamepadInfo& gamepad) {
+  std::lock_guard<std::mutex> lock(gamepad.snapshot_mutex);
+  const gamepad::Snapshot& snapshot = gamepad.snapshot;
+  std::vector<int32_t> buttons(snapshot.buttons.begin(),
+                               snapshot.buttons.end());
+  std::vector<int32_t> axes(snapshot.axes.begin(), snapshot.axes.end());
+  fl_value_set_string_take(
+      map, "buttons", fl_value_new_int32_list(buttons.data(), buttons.size()));
+  fl_value_set_string_take(map, "axes",
+                           fl_value_new_int32_list(axes.data(), axes.size()));
+  fl_value_set_string_take(map, "sequence",
+                           fl_value_new_int(snapshot.sequence));
+}
+
+/**
+ * Sends the whole state of a gamepad in one message, instead of one event per
+ * input, when it connects or is opened again.
+ */
+static void emit_snapshot(GamepadsLinuxPlugin* self,
+                          gamepad::GamepadInfo* gamepad,
+                          bool connected) {
+  FlValue* map = fl_value_new_map();
+  fl_value_set_string_take(map, "gamepadId",
+                           fl_value_new_string(gamepad->device_id.c_str()));
+  fl_value_set_string_take(map, "name",
+                           fl_value_new_string(gamepad->name.c_str()));
+  fl_value_set_string_take(map, "connected", fl_value_new_bool(connected));
+  set_snapshot(map, *gamepad);
+  enqueue_message(self, "onGamepadSnapshot", map);
+}
+
+static std::optional<patterns::Pattern> parse_pattern(FlValue* args) {
+  if (fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
+    return std::nullopt;
+  }
+  FlValue* id = fl_value_lookup_string(args, "id");
+  FlValue* type = fl_value_lookup_string(args, "type");
+  FlValue* buttons = fl_value_lookup_string(args, "buttons");
+  FlValue* window_ms = fl_value_lookup_string(args, "windowMs");
+  if (!id || fl_value_get_type(id) != FL_VALUE_TYPE_STRING || !type ||
+      fl_value_get_type(type) != FL_VALUE_TYPE_STRING || !buttons ||
+      fl_value_get_type(buttons) != FL_VALUE_TYPE_LIST || !window_ms ||
+      fl_value_get_type(window_ms) != FL_VALUE_TYPE_INT) {
+    return std::nullopt;
+  }
+
+  patterns::Pattern pattern;
+  pattern.id = fl_value_get_string(id);
+  if (strcmp(fl_value_get_string(type), "chord") == 0) {
+    pattern.type = patterns::PatternType::CHORD;
+  } else if (strcmp(fl_value_get_string(type), "sequence") == 0) {
+    pattern.type = patterns::PatternType::SEQUENCE;
+  } else {
+    return std::nullopt;
+  }
+  for (size_t i = 0; i < fl_value_get_length(buttons); i++) {
+    FlValue* button = fl_value_get_list_value(buttons, i);
+    if (fl_value_get_type(button) != FL_VALUE_TYPE_STRING) {
+      return std::nullopt;
+    }
+    // Keys are plain decimal numbers: strtol alone would also take an empty
+    // string as 0, and allow leading whitespace and signs.
+    const char* key = fl_value_get_string(button);
+    if (!isdigit(static_cast<unsigned char>(key[0]))) {
+      return std::nullopt;
+    }
+    char* end = nullptr;
+    long number = strtol(key, &end, 10);
+    if (end == key || *end != '\0' ||
+        number >= static_cast<long>(patterns::max_buttons)) {
+      return std::nullopt;
+    }
+    pattern.buttons.push_back(static_cast<uint8_t>(number));
+  }
+  if (pattern.buttons.empty() || fl_value_get_int(window_ms) < 0) {
+    return std::nullopt;
+  }
+  pattern.window_ms = static_cast<uint32_t>(fl_value_get_int(window_ms));
+  return pattern;
+}
+
+static void set_latency_summary(FlValue* map,
+                                const latency_stats::Summary& summary) {
+  fl_value_set_string_take(map, "count", fl_value_new_int(summary.count));
+  fl_value_set_string_take(map, "p50Ns", fl_value_new_int(summary.p50_ns));
+  fl_value_set_string_take(map, "p90Ns", fl_value_new_int(summary.p90_ns));
+  fl_value_set_string_take(map, "p99Ns", fl_value_new_int(summary.p99_ns));
+  fl_value_set_string_take(map, "p999Ns", fl_value_new_int(summary.p999_ns));
+  fl_value_set_string_take(map, "maxNs", fl_value_new_int(summary.max_ns));
 }
 
 static void respond_not_found(FlMethodCall* method_call) {
@@ -64,6 +313,13 @@ static void respond_not_found(FlMethodCall* method_call) {
   fl_method_call_respond(method_call, response, nullptr);
 }
 
+static void respond_invalid_arguments(FlMethodCall* method_call,
+                                      const gchar* message) {
+  g_autoptr(FlMethodResponse) response = FL_METHOD_RESPONSE(
+      fl_method_error_response_new("invalid_arguments", message, nullptr));
+  fl_method_call_respond(method_call, response, nullptr);
+}
+
 static void respond(FlMethodCall* method_call, FlValue* value) {
   g_autoptr(FlMethodResponse) response =
       FL_METHOD_RESPONSE(fl_method_success_response_new(value));
@@ -74,18 +330,129 @@ static void gamepads_linux_plugin_handle_method_call(
     GamepadsLinuxPlugin* self,
     FlMethodCall* method_call) {
   const gchar* method = fl_method_call_get_name(method_call);
+  PluginState* state = self->state;
 
   if (strcmp(method, "listGamepads") == 0) {
     g_autoptr(FlValue) list = fl_value_new_list();
-    for (auto [device_id, gamepad] : gamepads) {
+    state->core->for_each_gamepad([&](const gamepad::GamepadInfo& gamepad) {
       g_autoptr(FlValue) map = fl_value_new_map();
       fl_value_set(map, fl_value_new_string("id"),
-                   fl_value_new_string(device_id.c_str()));
+                   fl_value_new_string(gamepad.device_id.c_str()));
       fl_value_set(map, fl_value_new_string("name"),
                    fl_value_new_string(gamepad.name.c_str()));
+      set_snapshot(map, gamepad);
       fl_value_append(list, map);
-    }
+    });
     respond(method_call, list);
+  } else if (strcmp(method, "getLatencyStats") == 0) {
+    g_autoptr(FlValue) map = fl_value_new_map();
+    fl_value_set_string(
+        map, "lowLatency",
+        fl_value_new_bool(state->core->options().low_latency.enabled));
+    set_latency_summary(map, latency_stats::summarize());
+    FlValue* since_kernel = fl_value_new_map();
+    set_latency_summary(since_kernel, latency_stats::summarize_since_kernel());
+    fl_value_set_string_take(map, "sinceKernel", since_kernel);
+    fl_value_set_string_take(
+        map, "batchPoolMisses",
+        fl_value_new_int(
+            static_cast<int64_t>(native_port::batch_pool_misses())));
+    respond(method_call, map);
+  } else if (strcmp(method, "registerPattern") == 0) {
+    std::optional<patterns::Pattern> pattern =
+        parse_pattern(fl_method_call_get_args(method_call));
+    if (!pattern) {
+      respond_invalid_arguments(method_call, "Invalid pattern");
+      return;
+    }
+    pattern->owner = state->listener_id;
+    state->core->add_pattern(std::move(*pattern));
+    respond(method_call, nullptr);
+  } else if (strcmp(method, "unregisterPattern") == 0) {
+    FlValue* args = fl_method_call_get_args(method_call);
+    FlValue* id = fl_value_get_type(args) == FL_VALUE_TYPE_MAP
+                      ? fl_value_lookup_string(args, "id")
+                      : nullptr;
+    if (!id || fl_value_get_type(id) != FL_VALUE_TYPE_STRING) {
+      respond_invalid_arguments(method_call, "Missing pattern id");
+      return;
+    }
+    g_autoptr(FlValue) removed = fl_value_new_bool(state->core->remove_pattern(
+        state->listener_id, fl_value_get_string(id)));
+    respond(method_call, removed);
+  } else if (strcmp(method, "setEventsEnabled") == 0) {
+    FlValue* args = fl_method_call_get_args(method_call);
+    bool is_map = fl_value_get_type(args) == FL_VALUE_TYPE_MAP;
+    FlValue* enabled =
+        is_map ? fl_value_lookup_string(args, "enabled") : nullptr;
+    // Optional: a single gamepad, and a native port to subscribe instead of
+    // the method channel (see native_port.h).
+    FlValue* gamepad_id =
+        is_map ? fl_value_lookup_string(args, "gamepadId") : nullptr;
+    FlValue* port = is_map ? fl_value_lookup_string(args, "port") : nullptr;
+    if (!enabled || fl_value_get_type(enabled) != FL_VALUE_TYPE_BOOL ||
+        (gamepad_id && fl_value_get_type(gamepad_id) != FL_VALUE_TYPE_STRING) ||
+        (port && fl_value_get_type(port) != FL_VALUE_TYPE_INT)) {
+      respond_invalid_arguments(method_call, "Missing enabled flag");
+      return;
+    }
+    // Port handles are listener ids too; don't let an engine subscribe any
+    // other listener, such as the one of another engine.
+    if (port && !native_port::is_port_handle(fl_value_get_int(port))) {
+      respond_invalid_arguments(method_call, "Unknown port");
+      return;
+    }
+    input_core::ListenerId listener_id =
+        port ? static_cast<input_core::ListenerId>(fl_value_get_int(port))
+             : state->listener_id;
+    std::string device_id = gamepad_id ? fl_value_get_string(gamepad_id) : "";
+    if (fl_value_get_bool(enabled)) {
+      state->core->subscribe(listener_id, device_id);
+    } else {
+      state->core->unsubscribe(listener_id, device_id);
+    }
+    respond(method_call, nullptr);
+  } else if (strcmp(method, "getHistory") == 0) {
+    FlValue* args = fl_method_call_get_args(method_call);
+    bool is_map = fl_value_get_type(args) == FL_VALUE_TYPE_MAP;
+    FlValue* gamepad_id =
+        is_map ? fl_value_lookup_string(args, "gamepadId") : nullptr;
+    // Optional: without it (or with zero), the whole history is returned.
+    FlValue* since = is_map ? fl_value_lookup_string(args, "since") : nullptr;
+    if (!gamepad_id || fl_value_get_type(gamepad_id) != FL_VALUE_TYPE_STRING ||
+        (since && fl_value_get_type(since) != FL_VALUE_TYPE_INT)) {
+      respond_invalid_arguments(method_call, "Missing gamepad id");
+      return;
+    }
+    std::vector<js_event> events;
+    uint32_t since_ms =
+        since ? static_cast<uint32_t>(fl_value_get_int(since)) : 0;
+    if (!state->core->copy_history(fl_value_get_string(gamepad_id), since_ms,
+                                   events)) {
+      respond_invalid_arguments(method_call, "Unknown gamepad");
+      return;
+    }
+    // Sent as the packed records, see `GamepadHistory` on the Dart side.
+    g_autoptr(FlValue) records = fl_value_new_uint8_list(
+        reinterpret_cast<const uint8_t*>(events.data()),
+        events.size() * sizeof(js_event));
+    respond(method_call, records);
+  } else if (strcmp(method, "startTracing") == 0) {
+    FlValue* args = fl_method_call_get_args(method_call);
+    FlValue* path = fl_value_get_type(args) == FL_VALUE_TYPE_MAP
+                        ? fl_value_lookup_string(args, "path")
+                        : nullptr;
+    if (!path || fl_value_get_type(path) != FL_VALUE_TYPE_STRING) {
+      respond_invalid_arguments(method_call, "Missing trace path");
+      return;
+    }
+    trace::start(fl_value_get_string(path));
+    respond(method_call, nullptr);
+  } else if (strcmp(method, "stopTracing") == 0) {
+    std::optional<std::string> path = trace::stop();
+    g_autoptr(FlValue) result =
+        path ? fl_value_new_string(path->c_str()) : fl_value_new_null();
+    respond(method_call, result);
   } else {
     respond_not_found(method_call);
   }
@@ -104,59 +471,30 @@ void gamepads_linux_plugin_register_with_registrar(
       g_object_new(gamepads_linux_plugin_get_type(), nullptr));
 
   g_autoptr(FlStandardMethodCodec) codec = fl_standard_method_codec_new();
-  channel = fl_method_channel_new(fl_plugin_registrar_get_messenger(registrar),
-                                  "xyz.luan/gamepads", FL_METHOD_CODEC(codec));
+  plugin->channel =
+      fl_method_channel_new(fl_plugin_registrar_get_messenger(registrar),
+                            "xyz.luan/gamepads", FL_METHOD_CODEC(codec));
 
   fl_method_channel_set_method_call_handler(
-      channel, method_call_cb, g_object_ref(plugin), g_object_unref);
+      plugin->channel, method_call_cb, g_object_ref(plugin), g_object_unref);
 
   g_object_unref(plugin);
 }
 
-void process_connection_event(gamepad::GamepadInfo* gamepad) {
-  gamepad::listen(gamepad, [gamepad](const js_event& value) {
-    emit_gamepad_event(gamepad, value);
-  });
-}
-
-void event_loop_start() {
-  connection_listener::listen(
-      &keep_reading_events,
-      [](const connection_listener::ConnectionEvent& event) {
-        std::string key = event.device_id;
-        std::optional<gamepad::GamepadInfo> existingGamepad = gamepads[key];
-        if (event.type == connection_listener::ConnectionEventType::CONNECTED) {
-          if (existingGamepad && existingGamepad->alive) {
-            std::cout << "Existing gamepad found; skipping" << std::endl;
-            return;
-          }
-
-          std::optional<gamepad::GamepadInfo> info =
-              gamepad::get_gamepad_info(key);
-          if (!info) {
-            std::cerr << "Unable to open joystick for reading " << key
-                      << std::endl;
-            return;
-          }
-
-          std::cout << "Gamepad connected " << key << " - " << info->name
-                    << std::endl;
-          gamepads[key] = *info;
-
-          std::thread input_thread(process_connection_event, &gamepads[key]);
-          input_thread.detach();
-        } else {
-          std::cout << "Gamepad disconnected " << key << std::endl;
-          if (existingGamepad) {
-            gamepads[key].alive = false;
-            gamepads.erase(key);
-          }
-        }
-      });
-}
-
 static void gamepads_linux_plugin_dispose(GObject* object) {
-  keep_reading_events = false;
+  GamepadsLinuxPlugin* self = GAMEPADS_LINUX_PLUGIN(object);
+  if (self->state) {
+    // Waits for any callback still running on the reader threads.
+    self->state->core->remove_listener(self->state->listener_id);
+    for (size_t i = 0; i < self->state->queue_size; i++) {
+      if (self->state->queue[i].args) {
+        fl_value_unref(self->state->queue[i].args);
+      }
+    }
+    delete self->state;
+    self->state = nullptr;
+  }
+  g_clear_object(&self->channel);
   G_OBJECT_CLASS(gamepads_linux_plugin_parent_class)->dispose(object);
 }
 
@@ -165,8 +503,29 @@ static void gamepads_linux_plugin_class_init(GamepadsLinuxPluginClass* klass) {
 }
 
 static void gamepads_linux_plugin_init(GamepadsLinuxPlugin* self) {
-  keep_reading_events = true;
+  trace::start_from_env();
+
+  input_core::Options options = input_core::options_from_env();
+  latency_stats::lock_in_memory(options.low_latency);
+
+  self->state = new PluginState();
+  self->state->queue.resize(_queue_capacity);
+  self->state->drained_queue.resize(_queue_capacity);
+  self->state->core = input_core::InputCore::acquire(options);
 
-  std::thread event_loop_thread(event_loop_start);
-  event_loop_thread.detach();
+  input_core::Listener listener;
+  listener.on_event = [self](gamepad::GamepadInfo* gamepad,
+                             const js_event& event, uint64_t sequence) {
+    emit_gamepad_event(self, gamepad, event, sequence);
+  };
+  listener.on_pattern_matched = [self](gamepad::GamepadInfo* gamepad,
+                                       const patterns::Pattern& pattern,
+                                       const js_event& event) {
+    emit_pattern_matched(self, gamepad, pattern, event);
+  };
+  listener.on_snapshot = [self](gamepad::GamepadInfo* gamepad,
+                                bool connected) {
+    emit_snapshot(self, gamepad, connected);
+  };
+  self->state->listener_id = self->state->core->add_listener(listener);
 }
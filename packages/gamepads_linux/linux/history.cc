@@ -0,0 +1,77 @@
+#include <algorithm>
+
+#include "history.h"
+#include "utils.h"
+
+// How long before [latest] the given time is, modulo 2^32.
+static uint32_t _age(uint32_t time, uint32_t latest) {
+  return latest - time;
+}
+
+namespace history {
+Config config_from_env() {
+  Config config;
+  config.capacity = static_cast<size_t>(std::max(
+      0, int_from_env("GAMEPADS_HISTORY_EVENTS",
+                      static_cast<int>(config.capacity))));
+  config.max_age_ms = static_cast<uint32_t>(
+      std::max(0, int_from_env("GAMEPADS_HISTORY_MS", 0)));
+  return config;
+}
+
+void Ring::configure(const Config& config) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  records_.assign(config.capacity, js_event{});
+  records_.shrink_to_fit();
+  max_age_ms_ = config.max_age_ms;
+  start_ = 0;
+  size_ = 0;
+}
+
+void Ring::append(const js_event& event) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (records_.empty()) {
+    return;
+  }
+  if (max_age_ms_ > 0) {
+    while (size_ > 0 && _age(at(0).time, event.time) > max_age_ms_) {
+      start_ = (start_ + 1) % records_.size();
+      size_--;
+    }
+  }
+  if (size_ == records_.size()) {
+    start_ = (start_ + 1) % records_.size();
+    size_--;
+  }
+  records_[(start_ + size_) % records_.size()] = event;
+  size_++;
+}
+
+size_t Ring::copy_since(uint32_t since_ms, std::vector<js_event>& out) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (size_ == 0) {
+    return 0;
+  }
+  uint32_t latest = at(size_ - 1).time;
+  if (since_ms != 0 && static_cast<int32_t>(since_ms - latest) > 0) {
+    return 0;
+  }
+  uint32_t max_age = since_ms == 0 ? UINT32_MAX : _age(since_ms, latest);
+
+  // Binary search for the first record at or after [since_ms].
+  size_t low = 0;
+  size_t high = size_;
+  while (low < high) {
+    size_t middle = low + (high - low) / 2;
+    if (_age(at(middle).time, latest) <= max_age) {
+      high = middle;
+    } else {
+      low = middle + 1;
+    }
+  }
+  for (size_t i = low; i < size_; i++) {
+    out.push_back(at(i));
+  }
+  return size_ - low;
+}
+}  // namespace history
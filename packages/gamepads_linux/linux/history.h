@@ -0,0 +1,77 @@
+#ifndef GAMEPADS_LINUX_HISTORY_H_
+#define GAMEPADS_LINUX_HISTORY_H_
+
+#include <linux/joystick.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace history {
+/**
+ * How much input history is kept per gamepad, whichever limit is hit first.
+ *
+ * Read from the environment once at startup, see [config_from_env].
+ */
+struct Config {
+  // Maximum number of events kept; zero disables the history.
+  size_t capacity = 1024;
+  // Events this much older than the latest one are dropped; zero keeps them
+  // until they are overwritten.
+  uint32_t max_age_ms = 0;
+};
+
+/**
+ * Builds the configuration from the `GAMEPADS_HISTORY_EVENTS` and
+ * `GAMEPADS_HISTORY_MS` environment variables.
+ */
+Config config_from_env();
+
+/**
+ * A fixed-capacity ring of the most recent events of a gamepad, ordered by
+ * their timestamp.
+ *
+ * Events are kept as the 8-byte `js_event` records read from the device, so
+ * a slice of the history can be handed out as-is.
+ */
+class Ring {
+ public:
+  Ring() = default;
+
+  // Disallow copy and assign.
+  Ring(const Ring&) = delete;
+  Ring& operator=(const Ring&) = delete;
+
+  // Allocates the ring, dropping any recorded events.
+  void configure(const Config& config);
+
+  // Records an event, overwriting the oldest one when full.
+  void append(const js_event& event);
+
+  /**
+   * Appends the events with a timestamp at or after [since_ms] to [out], in
+   * order, returning how many were appended. A [since_ms] of zero appends
+   * every event.
+   *
+   * Timestamps wrap every ~49 days, and start close to wrapping, so they are
+   * compared by how long before the latest event they are. A [since_ms] up to
+   * ~24 days after the latest event appends nothing.
+   */
+  size_t copy_since(uint32_t since_ms, std::vector<js_event>& out) const;
+
+ private:
+  const js_event& at(size_t index) const {
+    return records_[(start_ + index) % records_.size()];
+  }
+
+  mutable std::mutex mutex_;
+  std::vector<js_event> records_;
+  uint32_t max_age_ms_ = 0;
+  // Index of the oldest record, and number of records kept.
+  size_t start_ = 0;
+  size_t size_ = 0;
+};
+}  // namespace history
+
+#endif  // GAMEPADS_LINUX_HISTORY_H_
@@ -0,0 +1,397 @@
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+#include "input_core.h"
+#include "trace.h"
+
+using namespace input_core;
+
+static void _wake(int wake_fd) {
+  if (eventfd_write(wake_fd, 1) != 0) {
+    std::cerr << "Failed to wake thread: " << strerror(errno) << std::endl;
+  }
+}
+
+namespace input_core {
+Options options_from_env() {
+  Options options;
+  const char* input_dir = std::getenv("GAMEPADS_INPUT_DIR");
+  if (input_dir != nullptr && *input_dir != '\0') {
+    options.input_dir = input_dir;
+    if (options.input_dir.back() != '/') {
+      options.input_dir += '/';
+    }
+  }
+  const char* node_type = std::getenv("GAMEPADS_INPUT_NODE_TYPE");
+  if (node_type != nullptr && strcmp(node_type, "fifo") == 0) {
+    options.is_node_type = connection_listener::is_fifo;
+  }
+  options.low_latency = low_latency::config_from_env();
+  options.history = history::config_from_env();
+  return options;
+}
+
+InputCore::InputCore(Options options) : options_(std::move(options)) {}
+
+InputCore::~InputCore() {
+  stop();
+}
+
+std::shared_ptr<InputCore> InputCore::acquire(const Options& options) {
+  static std::mutex mutex;
+  static std::weak_ptr<InputCore> shared;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  std::shared_ptr<InputCore> core = shared.lock();
+  if (!core) {
+    core = std::make_shared<InputCore>(options);
+    core->start();
+    shared = core;
+  }
+  return core;
+}
+
+ListenerId InputCore::add_listener(Listener listener) {
+  std::unique_lock<std::shared_mutex> lock(listeners_mutex_);
+  ListenerId id = next_listener_id_++;
+  listeners_[id].listener = std::move(listener);
+  return id;
+}
+
+void InputCore::remove_listener(ListenerId id) {
+  {
+    std::unique_lock<std::shared_mutex> lock(listeners_mutex_);
+    listeners_.erase(id);
+    patterns_.remove_owner(id);
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  update_activation();
+}
+
+void InputCore::subscribe(ListenerId id, const std::string& device_id) {
+  {
+    std::unique_lock<std::shared_mutex> lock(listeners_mutex_);
+    auto subscriber = listeners_.find(id);
+    if (subscriber == listeners_.end()) {
+      return;
+    }
+    if (device_id.empty()) {
+      subscriber->second.all_gamepads = true;
+    } else {
+      subscriber->second.gamepads.insert(device_id);
+    }
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  update_activation();
+}
+
+void InputCore::unsubscribe(ListenerId id, const std::string& device_id) {
+  {
+    std::unique_lock<std::shared_mutex> lock(listeners_mutex_);
+    auto subscriber = listeners_.find(id);
+    if (subscriber == listeners_.end()) {
+      return;
+    }
+    if (device_id.empty()) {
+      subscriber->second.all_gamepads = false;
+    } else {
+      subscriber->second.gamepads.erase(device_id);
+    }
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  update_activation();
+}
+
+void InputCore::add_pattern(patterns::Pattern pattern) {
+  patterns_.add(std::move(pattern));
+  std::lock_guard<std::mutex> lock(mutex_);
+  update_activation();
+}
+
+bool InputCore::remove_pattern(ListenerId owner, const std::string& id) {
+  if (!patterns_.remove(owner, id)) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  update_activation();
+  return true;
+}
+
+void InputCore::dispatch(gamepad::GamepadInfo* gamepad,
+                         const js_event& event,
+                         uint64_t sequence) {
+  gamepad->history.append(event);
+
+  std::shared_lock<std::shared_mutex> lock(listeners_mutex_);
+  {
+    trace::Span span("filter");
+    for (const patterns::Pattern* pattern :
+         gamepad->matcher.process(patterns_.current(), event)) {
+      trace::record_instant("pattern_matched");
+      auto subscriber = listeners_.find(pattern->owner);
+      if (subscriber != listeners_.end() &&
+          subscriber->second.listener.on_pattern_matched) {
+        subscriber->second.listener.on_pattern_matched(gamepad, *pattern,
+                                                       event);
+      }
+    }
+  }
+  for (const auto& [id, subscriber] : listeners_) {
+    if (subscriber.listener.on_event &&
+        subscriber.is_subscribed(gamepad->device_id)) {
+      subscriber.listener.on_event(gamepad, event, sequence);
+    }
+  }
+}
+
+void InputCore::dispatch_batch(gamepad::GamepadInfo* gamepad,
+                               const js_event* events,
+                               size_t count,
+                               uint64_t first_sequence) {
+  std::shared_lock<std::shared_mutex> lock(listeners_mutex_);
+  for (const auto& [id, subscriber] : listeners_) {
+    if (subscriber.listener.on_events &&
+        subscriber.is_subscribed(gamepad->device_id)) {
+      subscriber.listener.on_events(gamepad, events, count, first_sequence);
+    }
+  }
+}
+
+void InputCore::dispatch_snapshot(gamepad::GamepadInfo* gamepad,
+                                  bool connected) {
+  std::shared_lock<std::shared_mutex> lock(listeners_mutex_);
+  for (const auto& [id, subscriber] : listeners_) {
+    if (subscriber.listener.on_snapshot) {
+      subscriber.listener.on_snapshot(gamepad, connected);
+    }
+  }
+}
+
+void InputCore::fold_initial_state(gamepad::GamepadInfo* gamepad,
+                                   const js_event* events,
+                                   size_t count) {
+  std::shared_ptr<const patterns::PatternSet> set = patterns_.current();
+  for (size_t i = 0; i < count; i++) {
+    gamepad->matcher.process(set, events[i]);
+  }
+}
+
+gamepad::ReadCallbacks InputCore::read_callbacks(gamepad::GamepadInfo* gamepad,
+                                                 bool refreshed) {
+  gamepad::ReadCallbacks callbacks;
+  callbacks.on_event = [this, gamepad](const js_event& event,
+                                       uint64_t sequence) {
+    dispatch(gamepad, event, sequence);
+  };
+  callbacks.on_batch = [this, gamepad](const js_event* events, size_t count,
+                                       uint64_t first_sequence) {
+    dispatch_batch(gamepad, events, count, first_sequence);
+  };
+  callbacks.on_snapshot = [this, gamepad, refreshed](const js_event* events,
+                                                     size_t count) {
+    fold_initial_state(gamepad, events, count);
+    if (refreshed) {
+      dispatch_snapshot(gamepad, false);
+    }
+  };
+  return callbacks;
+}
+
+void InputCore::start() {
+  if (keep_reading_) {
+    return;
+  }
+  wake_fd_ = eventfd(0, EFD_CLOEXEC);
+  if (wake_fd_ == -1) {
+    std::cerr << "Failed to create eventfd: " << strerror(errno) << std::endl;
+    return;
+  }
+
+  keep_reading_ = true;
+  listener_thread_ = std::thread([this]() {
+    try {
+      connection_listener::listen(
+          options_.input_dir, options_.is_node_type, &keep_reading_, wake_fd_,
+          [this](const connection_listener::ConnectionEvent& event) {
+            handle_connection(event);
+          });
+    } catch (const std::exception& error) {
+      std::cerr << "Stopped listening for gamepads: " << error.what()
+                << std::endl;
+    }
+  });
+}
+
+void InputCore::stop() {
+  if (!keep_reading_) {
+    return;
+  }
+  keep_reading_ = false;
+  _wake(wake_fd_);
+  listener_thread_.join();
+  close(wake_fd_);
+  wake_fd_ = -1;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& [device_id, device] : devices_) {
+    deactivate(device);
+  }
+  devices_.clear();
+}
+
+void InputCore::for_each_gamepad(
+    const std::function<void(const gamepad::GamepadInfo&)>& visitor) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& [device_id, device] : devices_) {
+    if (device.is_connected()) {
+      visitor(*device.gamepad);
+    }
+  }
+}
+
+bool InputCore::copy_history(const std::string& device_id,
+                             uint32_t since_ms,
+                             std::vector<js_event>& out) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto device = devices_.find(device_id);
+  if (device == devices_.end() || !device->second.is_connected()) {
+    return false;
+  }
+  device->second.gamepad->history.copy_since(since_ms, out);
+  return true;
+}
+
+void InputCore::handle_connection(
+    const connection_listener::ConnectionEvent& event) {
+  if (event.type == connection_listener::ConnectionEventType::CONNECTED) {
+    connect(event.device_id);
+  } else {
+    disconnect(event.device_id);
+  }
+}
+
+void InputCore::connect(const std::string& device_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto existing = devices_.find(device_id);
+  if (existing != devices_.end()) {
+    if (existing->second.is_connected()) {
+      std::cout << "Existing gamepad found; skipping" << std::endl;
+      return;
+    }
+    // The reader gave up on the device; reap it before reconnecting.
+    deactivate(existing->second);
+    devices_.erase(existing);
+  }
+
+  std::unique_ptr<gamepad::GamepadInfo> info =
+      gamepad::get_gamepad_info(device_id, options_.open_device);
+  if (!info) {
+    std::cerr << "Unable to open joystick for reading " << device_id
+              << std::endl;
+    return;
+  }
+  info->history.configure(options_.history);
+
+  trace::record_instant("connected");
+  std::cout << "Gamepad connected " << device_id << " - " << info->name
+            << std::endl;
+  Device& device = devices_[device_id];
+  device.gamepad = std::move(info);
+  // The snapshot is sent once the gamepad is listed, below.
+  gamepad::read_initial_state(device.gamepad.get(),
+                              read_callbacks(device.gamepad.get(), false));
+  if (is_needed(device_id)) {
+    activate(device);
+  } else {
+    // Opened only to enumerate it; read it once someone needs it.
+    close(device.gamepad->file_descriptor);
+    device.gamepad->file_descriptor = -1;
+  }
+  dispatch_snapshot(device.gamepad.get(), true);
+}
+
+void InputCore::disconnect(const std::string& device_id) {
+  trace::record_instant("disconnected");
+  std::cout << "Gamepad disconnected " << device_id << std::endl;
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto existing = devices_.find(device_id);
+  if (existing == devices_.end()) {
+    return;
+  }
+  deactivate(existing->second);
+  devices_.erase(existing);
+}
+
+void InputCore::update_activation() {
+  for (auto& [device_id, device] : devices_) {
+    if (is_needed(device_id)) {
+      activate(device);
+    } else {
+      deactivate(device);
+    }
+  }
+}
+
+bool InputCore::is_needed(const std::string& device_id) {
+  if (!patterns_.current()->empty()) {
+    return true;
+  }
+  std::shared_lock<std::shared_mutex> lock(listeners_mutex_);
+  for (const auto& [id, subscriber] : listeners_) {
+    if (subscriber.is_subscribed(device_id)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void InputCore::activate(Device& device) {
+  if (device.active) {
+    return;
+  }
+  gamepad::GamepadInfo* gamepad = device.gamepad.get();
+  if (gamepad->file_descriptor == -1) {
+    gamepad->file_descriptor = options_.open_device(gamepad->device_id);
+    if (gamepad->file_descriptor == -1) {
+      std::cerr << "Unable to open joystick for reading "
+                << gamepad->device_id << ": " << strerror(errno) << std::endl;
+      return;
+    }
+  }
+  int wake_fd = eventfd(0, EFD_CLOEXEC);
+  if (wake_fd == -1) {
+    std::cerr << "Failed to create eventfd: " << strerror(errno) << std::endl;
+    close(gamepad->file_descriptor);
+    gamepad->file_descriptor = -1;
+    return;
+  }
+
+  gamepad->alive = true;
+  device.active = true;
+  device.wake_fd = wake_fd;
+  gamepad::ReadCallbacks callbacks = read_callbacks(gamepad, true);
+  device.thread = std::thread([this, gamepad, wake_fd, callbacks]() {
+    gamepad::listen(gamepad, wake_fd, options_.low_latency, callbacks);
+  });
+}
+
+void InputCore::deactivate(Device& device) {
+  if (!device.active) {
+    return;
+  }
+  device.gamepad->alive = false;
+  _wake(device.wake_fd);
+  device.thread.join();
+  close(device.wake_fd);
+  device.wake_fd = -1;
+  // The reader closes the gamepad's file descriptor when it stops.
+  device.gamepad->file_descriptor = -1;
+  device.gamepad->matcher.clear();
+  device.active = false;
+}
+}  // namespace input_core
@@ -0,0 +1,211 @@
+#ifndef GAMEPADS_LINUX_INPUT_CORE_H_
+#define GAMEPADS_LINUX_INPUT_CORE_H_
+
+#include <linux/joystick.h>
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "connection_listener.h"
+#include "gamepad.h"
+#include "history.h"
+#include "low_latency.h"
+#include "patterns.h"
+
+namespace input_core {
+struct Options {
+  // Directory watched for joystick nodes; must end with a slash.
+  std::string input_dir = "/dev/input/";
+  // Which kinds of directory entries are taken for joysticks when listing
+  // [input_dir].
+  connection_listener::NodeTypeFilter is_node_type =
+      connection_listener::is_character_device;
+  gamepad::DeviceOpener open_device = gamepad::open_device;
+  low_latency::Config low_latency = {};
+  history::Config history = {};
+};
+
+/**
+ * Builds the options from the environment, see [low_latency::config_from_env]
+ * and [history::config_from_env]. `GAMEPADS_INPUT_DIR` overrides the
+ * directory watched for joysticks, and `GAMEPADS_INPUT_NODE_TYPE=fifo` takes
+ * FIFOs instead of character devices for joysticks, e.g. to feed fake
+ * gamepads to benchmarks.
+ */
+Options options_from_env();
+
+using ListenerId = uint64_t;
+
+/**
+ * Receives what the core reads, on the reader threads.
+ *
+ * Callbacks must not add or remove listeners.
+ */
+struct Listener {
+  // Called for every event with its sequence number, see
+  // [gamepad::ReadCallbacks::on_event].
+  std::function<void(gamepad::GamepadInfo* gamepad,
+                     const js_event& event,
+                     uint64_t sequence)>
+      on_event;
+  // Called for the patterns registered with the listener's id as owner.
+  std::function<void(gamepad::GamepadInfo* gamepad,
+                     const patterns::Pattern& pattern,
+                     const js_event& event)>
+      on_pattern_matched;
+  // Called once per read from a gamepad with all the events read, after
+  // [on_event] was called for each of them. The events are numbered
+  // consecutively from [first_sequence].
+  std::function<void(gamepad::GamepadInfo* gamepad,
+                     const js_event* events,
+                     size_t count,
+                     uint64_t first_sequence)>
+      on_events;
+  // Called with every gamepad that connects, and whenever a gamepad's
+  // snapshot was refreshed because it was opened again ([connected] false).
+  // Read the snapshot under the gamepad's snapshot_mutex; it is kept up to
+  // date with every event, and its sequence number tells which events it
+  // already includes.
+  std::function<void(gamepad::GamepadInfo* gamepad, bool connected)>
+      on_snapshot;
+};
+
+/**
+ * Owns the connection listener and one reader thread per gamepad in use,
+ * independently of Flutter.
+ *
+ * Connected gamepads are enumerated with a single open and close, and only
+ * read while some listener subscribes to them or patterns are registered.
+ * Every device is read once, and its events are fanned out to the listeners
+ * subscribed to it.
+ */
+class InputCore {
+ public:
+  explicit InputCore(Options options);
+  ~InputCore();
+
+  /**
+   * Returns the process-wide core, starting it if nobody else holds it.
+   *
+   * The options only apply when the core is created.
+   */
+  static std::shared_ptr<InputCore> acquire(const Options& options);
+
+  // Disallow copy and assign.
+  InputCore(const InputCore&) = delete;
+  InputCore& operator=(const InputCore&) = delete;
+
+  // Starts listening for gamepads on a background thread.
+  void start();
+
+  // Stops every thread and closes every device, waiting for them to finish.
+  void stop();
+
+  ListenerId add_listener(Listener listener);
+
+  // Removes the listener, its subscriptions and its patterns. Once this
+  // returns, none of its callbacks are running or will be called again.
+  void remove_listener(ListenerId id);
+
+  /**
+   * Delivers the events of [device_id] (or of every gamepad, if empty) to the
+   * listener, reading the gamepad if nobody else needed it.
+   */
+  void subscribe(ListenerId id, const std::string& device_id = {});
+
+  /**
+   * Undoes [subscribe], closing the gamepads nobody needs anymore.
+   */
+  void unsubscribe(ListenerId id, const std::string& device_id = {});
+
+  // Patterns run on every gamepad; their owner is the listener to notify.
+  void add_pattern(patterns::Pattern pattern);
+
+  // Returns false if the owner had no pattern with the given id.
+  bool remove_pattern(ListenerId owner, const std::string& id);
+
+  const Options& options() const { return options_; }
+
+  // Visits the connected gamepads, whether they are being read or not; the
+  // visitor must not call back into the core.
+  void for_each_gamepad(
+      const std::function<void(const gamepad::GamepadInfo&)>& visitor);
+
+  /**
+   * Appends the recorded events of a gamepad with a timestamp at or after
+   * [since_ms] to [out]. Returns false if the gamepad is not connected.
+   */
+  bool copy_history(const std::string& device_id,
+                    uint32_t since_ms,
+                    std::vector<js_event>& out);
+
+ private:
+  struct Subscriber {
+    Listener listener;
+    bool all_gamepads = false;
+    std::set<std::string> gamepads;
+
+    bool is_subscribed(const std::string& device_id) const {
+      return all_gamepads || gamepads.count(device_id) != 0;
+    }
+  };
+
+  struct Device {
+    std::unique_ptr<gamepad::GamepadInfo> gamepad;
+    // Whether the gamepad is being read by [thread].
+    bool active = false;
+    int wake_fd = -1;
+    std::thread thread;
+
+    // Whether the gamepad is usable: either idle, or read without errors.
+    bool is_connected() const { return !active || gamepad->alive; }
+  };
+
+  void dispatch(gamepad::GamepadInfo* gamepad,
+                const js_event& event,
+                uint64_t sequence);
+  void dispatch_batch(gamepad::GamepadInfo* gamepad,
+                      const js_event* events,
+                      size_t count,
+                      uint64_t first_sequence);
+  void dispatch_snapshot(gamepad::GamepadInfo* gamepad, bool connected);
+  // Runs the initial state through the gamepad's matcher, so that buttons
+  // held when it was opened count towards chords.
+  void fold_initial_state(gamepad::GamepadInfo* gamepad,
+                          const js_event* events,
+                          size_t count);
+  // Callbacks passing what is read from the gamepad to the listeners; the
+  // snapshot is only dispatched if [refreshed] is set.
+  gamepad::ReadCallbacks read_callbacks(gamepad::GamepadInfo* gamepad,
+                                        bool refreshed);
+  void handle_connection(const connection_listener::ConnectionEvent& event);
+  void connect(const std::string& device_id);
+  void disconnect(const std::string& device_id);
+  // Starts or stops reading each gamepad as needed; mutex_ must be held.
+  void update_activation();
+  bool is_needed(const std::string& device_id);
+  void activate(Device& device);
+  static void deactivate(Device& device);
+
+  Options options_;
+  patterns::Registry patterns_;
+  std::shared_mutex listeners_mutex_;
+  std::map<ListenerId, Subscriber> listeners_;
+  ListenerId next_listener_id_ = 1;
+  std::atomic<bool> keep_reading_ = false;
+  int wake_fd_ = -1;
+  std::thread listener_thread_;
+  std::mutex mutex_;
+  std::map<std::string, Device> devices_;
+};
+}  // namespace input_core
+
+#endif  // GAMEPADS_LINUX_INPUT_CORE_H_
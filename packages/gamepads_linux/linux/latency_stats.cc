@@ -0,0 +1,98 @@
+#include <time.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <limits>
+#include <vector>
+
+#include "latency_stats.h"
+
+static constexpr size_t _window_size = 4096;
+
+// `INITIAL_JIFFIES`: the kernel starts counting 5 minutes before boot, so
+// that wraparound bugs show up early.
+static constexpr uint64_t _initial_jiffies_ms = 300000;
+
+struct _Window {
+  std::array<std::atomic<uint32_t>, _window_size> samples = {};
+  std::atomic<uint64_t> count = 0;
+};
+
+static _Window _read_to_emit;
+static _Window _kernel_to_emit;
+
+static uint32_t _percentile(const std::vector<uint32_t>& sorted,
+                            double percentile) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  size_t index = static_cast<size_t>(percentile * (sorted.size() - 1));
+  return sorted[index];
+}
+
+static void _record(_Window& window, uint64_t elapsed_ns) {
+  uint32_t sample = static_cast<uint32_t>(
+      std::min<uint64_t>(elapsed_ns, std::numeric_limits<uint32_t>::max()));
+  uint64_t index = window.count.fetch_add(1, std::memory_order_relaxed);
+  window.samples[index % _window_size].store(sample,
+                                             std::memory_order_relaxed);
+}
+
+static latency_stats::Summary _summarize(const _Window& window) {
+  uint64_t count = window.count.load(std::memory_order_relaxed);
+  size_t size = static_cast<size_t>(std::min<uint64_t>(count, _window_size));
+
+  std::vector<uint32_t> sorted(size);
+  for (size_t i = 0; i < size; i++) {
+    sorted[i] = window.samples[i].load(std::memory_order_relaxed);
+  }
+  std::sort(sorted.begin(), sorted.end());
+
+  return {
+      count,
+      _percentile(sorted, 0.5),
+      _percentile(sorted, 0.9),
+      _percentile(sorted, 0.99),
+      _percentile(sorted, 0.999),
+      sorted.empty() ? 0 : sorted.back(),
+  };
+}
+
+namespace latency_stats {
+uint64_t now_ns() {
+  timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return static_cast<uint64_t>(time.tv_sec) * 1000000000 + time.tv_nsec;
+}
+
+uint32_t to_event_time_ms(uint64_t monotonic_ns) {
+  return static_cast<uint32_t>(monotonic_ns / 1000000 - _initial_jiffies_ms);
+}
+
+void lock_in_memory(const low_latency::Config& config) {
+  low_latency::lock_memory(config, &_read_to_emit, sizeof(_read_to_emit));
+  low_latency::lock_memory(config, &_kernel_to_emit, sizeof(_kernel_to_emit));
+}
+
+void record(uint64_t read_ns, uint64_t emit_ns) {
+  _record(_read_to_emit, emit_ns - read_ns);
+}
+
+void record_since_kernel(uint32_t event_time_ms, uint64_t emit_ns) {
+  // Both clocks tick at their own pace, so an event may look slightly newer
+  // than now; count that as no latency.
+  int32_t elapsed_ms =
+      static_cast<int32_t>(to_event_time_ms(emit_ns) - event_time_ms);
+  _record(_kernel_to_emit,
+          static_cast<uint64_t>(std::max<int32_t>(elapsed_ms, 0)) * 1000000);
+}
+
+Summary summarize() {
+  return _summarize(_read_to_emit);
+}
+
+Summary summarize_since_kernel() {
+  return _summarize(_kernel_to_emit);
+}
+}  // namespace latency_stats
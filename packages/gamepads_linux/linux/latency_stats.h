@@ -0,0 +1,53 @@
+#ifndef GAMEPADS_LINUX_LATENCY_STATS_H_
+#define GAMEPADS_LINUX_LATENCY_STATS_H_
+
+#include <cstdint>
+
+#include "low_latency.h"
+
+/**
+ * Tracks how long it takes from reading an event off the device until it is
+ * handed over to the consumer (read-to-emit), and from the kernel timestamp
+ * of the event until then (kernel-to-emit).
+ *
+ * Samples are kept in fixed, preallocated windows so recording them never
+ * allocates; only the most recent samples are taken into account.
+ */
+namespace latency_stats {
+struct Summary {
+  uint64_t count;
+  uint32_t p50_ns;
+  uint32_t p90_ns;
+  uint32_t p99_ns;
+  uint32_t p999_ns;
+  uint32_t max_ns;
+};
+
+uint64_t now_ns();
+
+/**
+ * Converts a `CLOCK_MONOTONIC` time to the clock of `js_event::time`, i.e.
+ * jiffies in milliseconds, which start 5 minutes before boot and wrap around.
+ */
+uint32_t to_event_time_ms(uint64_t monotonic_ns);
+
+void lock_in_memory(const low_latency::Config& config);
+
+void record(uint64_t read_ns, uint64_t emit_ns);
+
+/**
+ * Records the time since [event_time_ms], the kernel timestamp of an event.
+ *
+ * The kernel only timestamps events with the jiffies' granularity, so these
+ * samples are precise to a millisecond at best.
+ */
+void record_since_kernel(uint32_t event_time_ms, uint64_t emit_ns);
+
+// Summarizes the read-to-emit samples.
+Summary summarize();
+
+// Summarizes the kernel-to-emit samples.
+Summary summarize_since_kernel();
+}  // namespace latency_stats
+
+#endif  // GAMEPADS_LINUX_LATENCY_STATS_H_
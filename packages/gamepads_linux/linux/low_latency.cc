@@ -0,0 +1,72 @@
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <iostream>
+
+#include "low_latency.h"
+#include "utils.h"
+
+namespace low_latency {
+Config config_from_env() {
+  Config config;
+  config.enabled = int_from_env("GAMEPADS_LOW_LATENCY", 0) != 0;
+  config.cpu = int_from_env("GAMEPADS_LOW_LATENCY_CPU", config.cpu);
+  config.priority =
+      int_from_env("GAMEPADS_LOW_LATENCY_PRIORITY", config.priority);
+  config.busy_poll_us =
+      int_from_env("GAMEPADS_LOW_LATENCY_BUSY_POLL_US", config.busy_poll_us);
+  return config;
+}
+
+void apply_to_current_thread(const Config& config) {
+  if (!config.enabled) {
+    return;
+  }
+
+  sched_param param = {};
+  param.sched_priority = config.priority;
+  int result = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+  if (result != 0) {
+    std::cerr << "SCHED_FIFO not permitted (" << strerror(result)
+              << "); falling back to nice " << config.nice << std::endl;
+    pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+    if (setpriority(PRIO_PROCESS, tid, config.nice) != 0) {
+      std::cerr << "Unable to raise reader priority: " << strerror(errno)
+                << std::endl;
+    }
+  }
+
+  if (config.cpu >= 0) {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(config.cpu, &cpus);
+    result = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+    if (result != 0) {
+      std::cerr << "Unable to pin reader to CPU " << config.cpu << ": "
+                << strerror(result) << std::endl;
+    }
+  }
+}
+
+void lock_memory(const Config& config, const void* address, size_t length) {
+  if (!config.enabled) {
+    return;
+  }
+  if (mlock(address, length) != 0) {
+    std::cerr << "Unable to lock reader buffers: " << strerror(errno)
+              << std::endl;
+  }
+}
+
+void unlock_memory(const Config& config, const void* address, size_t length) {
+  if (!config.enabled) {
+    return;
+  }
+  munlock(address, length);
+}
+}  // namespace low_latency
@@ -0,0 +1,48 @@
+#ifndef GAMEPADS_LINUX_LOW_LATENCY_H_
+#define GAMEPADS_LINUX_LOW_LATENCY_H_
+
+#include <cstddef>
+
+namespace low_latency {
+/**
+ * Opt-in tuning for the gamepad reader threads.
+ *
+ * Read from the environment once at startup, see [config_from_env].
+ */
+struct Config {
+  bool enabled = false;
+  // CPU the reader threads are pinned to, or -1 to leave affinity alone.
+  int cpu = -1;
+  // SCHED_FIFO priority requested for the reader threads.
+  int priority = 10;
+  // Nice level used when SCHED_FIFO is not permitted.
+  int nice = -10;
+  // How long to keep polling the device after an event before going back to
+  // a blocking read. Zero disables busy-polling, as does [enabled] being off.
+  int busy_poll_us = 0;
+};
+
+/**
+ * Builds the configuration from the `GAMEPADS_LOW_LATENCY`,
+ * `GAMEPADS_LOW_LATENCY_CPU`, `GAMEPADS_LOW_LATENCY_PRIORITY` and
+ * `GAMEPADS_LOW_LATENCY_BUSY_POLL_US` environment variables.
+ */
+Config config_from_env();
+
+/**
+ * Raises the scheduling class of the calling thread and pins it, falling back
+ * to a high nice level (or to the defaults) when the process lacks the
+ * privileges to do so. Does nothing if the config is not enabled.
+ */
+void apply_to_current_thread(const Config& config);
+
+/**
+ * Locks the given memory range so accessing it never page-faults. Does
+ * nothing if the config is not enabled.
+ */
+void lock_memory(const Config& config, const void* address, size_t length);
+
+void unlock_memory(const Config& config, const void* address, size_t length);
+}  // namespace low_latency
+
+#endif  // GAMEPADS_LINUX_LOW_LATENCY_H_
@@ -0,0 +1,217 @@
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+
+#include "mappings.h"
+
+using namespace mappings;
+
+/**
+ * A known controller, with its layout in the format used by SDL's
+ * gamecontrollerdb (`a:b0,b:b1,leftx:a0,dpleft:-a6,...`).
+ *
+ * The d-pad is expected to be reported as a pair of hat axes, which is how
+ * joydev exposes it. A version of 0 matches any version of the device.
+ */
+struct Entry {
+  DeviceId id;
+  const char* name;
+  std::string_view layout;
+};
+
+// clang-format off
+static constexpr std::string_view _xinput_layout =
+    "a:b0,b:b1,x:b2,y:b3,leftshoulder:b4,rightshoulder:b5,back:b6,start:b7,"
+    "guide:b8,leftstick:b9,rightstick:b10,leftx:a0,lefty:a1,lefttrigger:a2,"
+    "rightx:a3,righty:a4,righttrigger:a5,dpleft:-a6,dpright:+a6,dpup:-a7,"
+    "dpdown:+a7";
+
+static constexpr std::string_view _playstation_layout =
+    "a:b0,b:b1,y:b2,x:b3,leftshoulder:b4,rightshoulder:b5,back:b8,start:b9,"
+    "guide:b10,leftstick:b11,rightstick:b12,leftx:a0,lefty:a1,lefttrigger:a2,"
+    "rightx:a3,righty:a4,righttrigger:a5,dpleft:-a6,dpright:+a6,dpup:-a7,"
+    "dpdown:+a7";
+
+static constexpr Entry _entries[] = {
+    {{0x045e, 0x028e, 0}, "Xbox 360 Controller", _xinput_layout},
+    {{0x045e, 0x0719, 0}, "Xbox 360 Wireless Receiver", _xinput_layout},
+    {{0x045e, 0x02d1, 0}, "Xbox One Controller", _xinput_layout},
+    {{0x045e, 0x02dd, 0}, "Xbox One Controller", _xinput_layout},
+    {{0x045e, 0x02ea, 0}, "Xbox One S Controller", _xinput_layout},
+    {{0x045e, 0x0b12, 0}, "Xbox Series X|S Controller", _xinput_layout},
+    {{0x046d, 0xc21d, 0}, "Logitech Gamepad F310", _xinput_layout},
+    {{0x046d, 0xc21f, 0}, "Logitech Gamepad F710", _xinput_layout},
+    {{0x054c, 0x05c4, 0}, "PS4 Controller", _playstation_layout},
+    {{0x054c, 0x09cc, 0}, "PS4 Controller", _playstation_layout},
+    {{0x054c, 0x0ce6, 0}, "PS5 Controller", _playstation_layout},
+};
+// clang-format on
+
+static constexpr size_t _entry_count = sizeof(_entries) / sizeof(_entries[0]);
+
+static constexpr uint8_t _standard_button(std::string_view name) {
+  if (name == "a") return SOUTH;
+  if (name == "b") return EAST;
+  if (name == "x") return WEST;
+  if (name == "y") return NORTH;
+  if (name == "leftshoulder") return LEFT_SHOULDER;
+  if (name == "rightshoulder") return RIGHT_SHOULDER;
+  if (name == "back") return BACK;
+  if (name == "start") return START;
+  if (name == "guide") return GUIDE;
+  if (name == "leftstick") return LEFT_STICK;
+  if (name == "rightstick") return RIGHT_STICK;
+  return unmapped;
+}
+
+static constexpr uint8_t _standard_axis(std::string_view name) {
+  if (name == "leftx") return LEFT_X;
+  if (name == "lefty") return LEFT_Y;
+  if (name == "rightx") return RIGHT_X;
+  if (name == "righty") return RIGHT_Y;
+  if (name == "lefttrigger") return LEFT_TRIGGER;
+  if (name == "righttrigger") return RIGHT_TRIGGER;
+  if (name == "dpleft" || name == "dpright") return DPAD_X;
+  if (name == "dpup" || name == "dpdown") return DPAD_Y;
+  return unmapped;
+}
+
+static constexpr size_t _parse_index(std::string_view digits) {
+  if (digits.empty()) {
+    throw std::invalid_argument("Missing input index in mapping");
+  }
+  size_t index = 0;
+  for (char digit : digits) {
+    if (digit < '0' || digit > '9') {
+      throw std::invalid_argument("Invalid input index in mapping");
+    }
+    index = index * 10 + (digit - '0');
+  }
+  return index;
+}
+
+static constexpr Mapping _parse(const Entry& entry) {
+  Mapping mapping = {entry.name, {}, {}};
+  mapping.buttons.fill(unmapped);
+  mapping.axes.fill(unmapped);
+
+  std::string_view layout = entry.layout;
+  while (!layout.empty()) {
+    size_t comma = layout.find(',');
+    std::string_view field = layout.substr(0, comma);
+    layout = comma == std::string_view::npos ? "" : layout.substr(comma + 1);
+
+    size_t colon = field.find(':');
+    if (colon == std::string_view::npos) {
+      throw std::invalid_argument("Invalid mapping field");
+    }
+    std::string_view name = field.substr(0, colon);
+    std::string_view input = field.substr(colon + 1);
+    if (!input.empty() && (input[0] == '+' || input[0] == '-')) {
+      input.remove_prefix(1);
+    }
+    if (input.empty()) {
+      throw std::invalid_argument("Invalid mapping field");
+    }
+
+    size_t index = _parse_index(input.substr(1));
+    if (input[0] == 'b' && index < max_buttons) {
+      mapping.buttons[index] = _standard_button(name);
+    } else if (input[0] == 'a' && index < max_axes) {
+      mapping.axes[index] = _standard_axis(name);
+    } else {
+      throw std::invalid_argument("Unsupported mapping input");
+    }
+  }
+  return mapping;
+}
+
+static constexpr uint64_t _key(const DeviceId& id) {
+  return (static_cast<uint64_t>(id.vendor) << 32) |
+         (static_cast<uint64_t>(id.product) << 16) | id.version;
+}
+
+// SplitMix64 finalizer.
+static constexpr uint64_t _hash(uint64_t key, uint64_t seed) {
+  uint64_t hash = key + seed;
+  hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9;
+  hash = (hash ^ (hash >> 27)) * 0x94d049bb133111eb;
+  return hash ^ (hash >> 31);
+}
+
+static constexpr size_t _table_size = [] {
+  size_t size = 1;
+  while (size < _entry_count * 2) {
+    size *= 2;
+  }
+  return size;
+}();
+
+/**
+ * A collision-free hash table over the entries, found by trying seeds until
+ * every key lands in its own slot.
+ */
+struct PerfectHashTable {
+  uint64_t seed;
+  std::array<uint8_t, _table_size> slots;
+};
+
+static constexpr PerfectHashTable _build_table() {
+  static_assert(_entry_count < unmapped, "Too many mappings");
+  for (uint64_t seed = 0; seed < 100000; seed++) {
+    PerfectHashTable table = {seed, {}};
+    table.slots.fill(unmapped);
+    bool collision = false;
+    for (size_t i = 0; i < _entry_count && !collision; i++) {
+      size_t slot = _hash(_key(_entries[i].id), seed) & (_table_size - 1);
+      collision = table.slots[slot] != unmapped;
+      table.slots[slot] = static_cast<uint8_t>(i);
+    }
+    if (!collision) {
+      return table;
+    }
+  }
+  throw std::logic_error("No perfect hash seed found for the mappings");
+}
+
+static constexpr std::array<Mapping, _entry_count> _build_mappings() {
+  std::array<Mapping, _entry_count> mappings = {};
+  for (size_t i = 0; i < _entry_count; i++) {
+    mappings[i] = _parse(_entries[i]);
+  }
+  return mappings;
+}
+
+static constexpr PerfectHashTable _table = _build_table();
+static constexpr std::array<Mapping, _entry_count> _mappings =
+    _build_mappings();
+
+static const Mapping* _lookup(const DeviceId& id) {
+  uint64_t key = _key(id);
+  uint8_t index = _table.slots[_hash(key, _table.seed) & (_table_size - 1)];
+  if (index == unmapped || _key(_entries[index].id) != key) {
+    return nullptr;
+  }
+  return &_mappings[index];
+}
+
+namespace mappings {
+const std::array<const char*, STANDARD_BUTTON_COUNT> button_names = {
+    "south", "east",  "west",  "north",    "leftShoulder", "rightShoulder",
+    "back",  "start", "guide", "leftStick", "rightStick",
+};
+
+const std::array<const char*, STANDARD_AXIS_COUNT> axis_names = {
+    "leftX",       "leftY",        "rightX", "rightY",
+    "leftTrigger", "rightTrigger", "dpadX",  "dpadY",
+};
+
+const Mapping* find(const DeviceId& id) {
+  const Mapping* mapping = _lookup(id);
+  if (mapping == nullptr && id.version != 0) {
+    mapping = _lookup({id.vendor, id.product, 0});
+  }
+  return mapping;
+}
+}  // namespace mappings
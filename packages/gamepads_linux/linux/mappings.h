@@ -0,0 +1,115 @@
+#ifndef GAMEPADS_LINUX_MAPPINGS_H_
+#define GAMEPADS_LINUX_MAPPINGS_H_
+
+#include <linux/joystick.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Maps the raw joydev button and axis numbers of known controllers to a
+ * standard layout.
+ *
+ * The mappings are compiled in, so resolving one when a gamepad connects is a
+ * single hash table lookup, and remapping an event is a single array index.
+ */
+namespace mappings {
+constexpr size_t max_buttons = 32;
+constexpr size_t max_axes = 16;
+
+// Marks raw buttons and axes that have no standard counterpart.
+constexpr uint8_t unmapped = 0xff;
+
+enum StandardButton : uint8_t {
+  SOUTH,
+  EAST,
+  WEST,
+  NORTH,
+  LEFT_SHOULDER,
+  RIGHT_SHOULDER,
+  BACK,
+  START,
+  GUIDE,
+  LEFT_STICK,
+  RIGHT_STICK,
+  STANDARD_BUTTON_COUNT,
+};
+
+enum StandardAxis : uint8_t {
+  LEFT_X,
+  LEFT_Y,
+  RIGHT_X,
+  RIGHT_Y,
+  LEFT_TRIGGER,
+  RIGHT_TRIGGER,
+  DPAD_X,
+  DPAD_Y,
+  STANDARD_AXIS_COUNT,
+};
+
+struct DeviceId {
+  uint16_t vendor;
+  uint16_t product;
+  uint16_t version;
+};
+
+struct Mapping {
+  const char* name;
+  // Standard button (or [unmapped]) for each raw button number.
+  std::array<uint8_t, max_buttons> buttons;
+  // Standard axis (or [unmapped]) for each raw axis number.
+  std::array<uint8_t, max_axes> axes;
+};
+
+/**
+ * Finds the mapping for the given device, preferring one for its exact
+ * version over one matching any version.
+ *
+ * Returns nullptr for unknown devices.
+ */
+const Mapping* find(const DeviceId& id);
+
+extern const std::array<const char*, STANDARD_BUTTON_COUNT> button_names;
+extern const std::array<const char*, STANDARD_AXIS_COUNT> axis_names;
+
+/**
+ * Returns the name of the standard input the event maps to, or nullptr.
+ */
+inline const char* standard_key(const Mapping* mapping, const js_event& event) {
+  if (mapping == nullptr) {
+    return nullptr;
+  }
+  uint8_t standard = unmapped;
+  if ((event.type & ~JS_EVENT_INIT) == JS_EVENT_BUTTON) {
+    if (event.number < max_buttons) {
+      standard = mapping->buttons[event.number];
+    }
+    return standard == unmapped ? nullptr : button_names[standard];
+  }
+  if (event.number < max_axes) {
+    standard = mapping->axes[event.number];
+  }
+  return standard == unmapped ? nullptr : axis_names[standard];
+}
+
+/**
+ * Returns the standard input the event maps to as an index into the buttons
+ * followed by the axes (i.e. axes start at STANDARD_BUTTON_COUNT), or
+ * [unmapped].
+ */
+inline uint8_t standard_index(const Mapping* mapping, const js_event& event) {
+  if (mapping == nullptr) {
+    return unmapped;
+  }
+  if ((event.type & ~JS_EVENT_INIT) == JS_EVENT_BUTTON) {
+    return event.number < max_buttons ? mapping->buttons[event.number]
+                                      : unmapped;
+  }
+  uint8_t axis = event.number < max_axes ? mapping->axes[event.number]
+                                         : unmapped;
+  return axis == unmapped ? unmapped : STANDARD_BUTTON_COUNT + axis;
+}
+}  // namespace mappings
+
+#endif  // GAMEPADS_LINUX_MAPPINGS_H_
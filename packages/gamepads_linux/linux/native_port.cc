@@ -0,0 +1,262 @@
+#include <dart_native_api.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "gamepad.h"
+#include "input_core.h"
+#include "mappings.h"
+#include "native_port.h"
+#include "trace.h"
+#include "utils.h"
+
+using PostCObject = bool (*)(Dart_Port port, Dart_CObject* message);
+
+struct OpenPort {
+  std::shared_ptr<input_core::InputCore> core;
+  input_core::ListenerId listener_id;
+};
+
+static std::mutex _mutex;
+static std::map<int64_t, OpenPort> _ports;
+
+// Batches a pool holds: each is only back once Dart collected its `Uint8List`.
+static constexpr size_t _pool_batches = 32;
+// Bytes of the largest batch, see [gamepads_linux_open_port].
+static constexpr size_t _batch_bytes =
+    gamepad::max_batch_events * (sizeof(js_event) + 1);
+
+static std::atomic<uint64_t> _pool_misses = 0;
+
+class BatchPool;
+
+/**
+ * Header of the data of a posted batch, passed to Dart as its peer.
+ */
+struct Batch {
+  // The pool to return the batch to, or nullptr if it was allocated on its
+  // own.
+  BatchPool* pool;
+
+  uint8_t* data() { return reinterpret_cast<uint8_t*>(this + 1); }
+};
+
+/**
+ * Preallocated batches of a reader thread.
+ *
+ * Batches come back from their finalizer on a Dart thread, possibly after the
+ * reader is gone, so the pool is counted as a reference by each batch taken
+ * from it and deleted by whoever releases the last one.
+ */
+class BatchPool {
+ public:
+  BatchPool() : slots_(_pool_batches) {
+    free_.reserve(_pool_batches);
+    for (Slot& slot : slots_) {
+      slot.batch.pool = this;
+      free_.push_back(&slot.batch);
+    }
+  }
+
+  /**
+   * Takes a batch out of the pool, or returns nullptr if they are all posted.
+   */
+  Batch* take() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (free_.empty()) {
+      return nullptr;
+    }
+    Batch* batch = free_.back();
+    free_.pop_back();
+    references_++;
+    return batch;
+  }
+
+  void give_back(Batch* batch) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      free_.push_back(batch);
+    }
+    release();
+  }
+
+  void release() {
+    if (references_.fetch_sub(1) == 1) {
+      delete this;
+    }
+  }
+
+ private:
+  struct Slot {
+    Batch batch;
+    uint8_t data[_batch_bytes];
+  };
+
+  // One for the reader thread, plus one for each batch taken.
+  std::atomic<size_t> references_ = 1;
+  std::mutex mutex_;
+  std::vector<Slot> slots_;
+  std::vector<Batch*> free_;
+};
+
+/**
+ * Holds the pool of the current reader thread until it exits.
+ */
+struct PoolOwner {
+  BatchPool* pool = new BatchPool();
+
+  ~PoolOwner() { pool->release(); }
+};
+
+static thread_local PoolOwner _pool_owner;
+
+static void _free_batch([[maybe_unused]] void* isolate_callback_data,
+                        void* peer) {
+  Batch* batch = static_cast<Batch*>(peer);
+  if (batch->pool != nullptr) {
+    batch->pool->give_back(batch);
+  } else {
+    free(batch);
+  }
+}
+
+/**
+ * Takes a batch with room for [length] bytes from the pool of the current
+ * thread, or allocates one if there is none left.
+ */
+static Batch* _take_batch(size_t length) {
+  Batch* batch = length <= _batch_bytes ? _pool_owner.pool->take() : nullptr;
+  if (batch == nullptr) {
+    _pool_misses++;
+    batch = static_cast<Batch*>(malloc(sizeof(Batch) + length));
+    if (batch != nullptr) {
+      batch->pool = nullptr;
+    }
+  }
+  return batch;
+}
+
+/**
+ * Posts a batch of events, returning false if the port is gone.
+ */
+static bool _post_events(Dart_Port port,
+                         PostCObject post,
+                         gamepad::GamepadInfo* gamepad,
+                         const js_event* events,
+                         size_t count,
+                         uint64_t first_sequence) {
+  size_t records_length = count * sizeof(js_event);
+  size_t length = records_length + count;
+  Batch* buffer = _take_batch(length);
+  if (buffer == nullptr) {
+    return true;
+  }
+  uint8_t* data = buffer->data();
+  {
+    trace::Span span("encode");
+    memcpy(data, events, records_length);
+    for (size_t i = 0; i < count; i++) {
+      data[records_length + i] =
+          mappings::standard_index(gamepad->mapping, events[i]);
+    }
+  }
+
+  Dart_CObject gamepad_id;
+  gamepad_id.type = Dart_CObject_kString;
+  gamepad_id.value.as_string = gamepad->device_id.c_str();
+
+  Dart_CObject batch;
+  batch.type = Dart_CObject_kExternalTypedData;
+  batch.value.as_external_typed_data.type = Dart_TypedData_kUint8;
+  batch.value.as_external_typed_data.length = static_cast<intptr_t>(length);
+  batch.value.as_external_typed_data.data = data;
+  batch.value.as_external_typed_data.peer = buffer;
+  batch.value.as_external_typed_data.callback = _free_batch;
+
+  Dart_CObject sequence;
+  sequence.type = Dart_CObject_kInt64;
+  sequence.value.as_int64 = static_cast<int64_t>(first_sequence);
+
+  Dart_CObject* values[] = {&gamepad_id, &batch, &sequence};
+  Dart_CObject message;
+  message.type = Dart_CObject_kArray;
+  message.value.as_array.length = 3;
+  message.value.as_array.values = values;
+
+  trace::Span span("post");
+  if (!post(port, &message)) {
+    // Ownership of the data stays with us when the message is not enqueued.
+    _free_batch(nullptr, buffer);
+    return false;
+  }
+  return true;
+}
+
+int64_t gamepads_linux_open_port(int64_t port, void* post_cobject) {
+  if (int_from_env("GAMEPADS_NATIVE_PORTS", 1) == 0) {
+    return -1;
+  }
+  PostCObject post = reinterpret_cast<PostCObject>(post_cobject);
+  auto open = std::make_shared<std::atomic<bool>>(true);
+  // Only known once the listener is added, but nothing is posted until the
+  // handle is returned and used to subscribe.
+  auto handle = std::make_shared<std::atomic<int64_t>>(-1);
+
+  std::shared_ptr<input_core::InputCore> core =
+      input_core::InputCore::acquire(input_core::options_from_env());
+  input_core::Listener listener;
+  listener.on_events = [port, post, open, handle](
+                           gamepad::GamepadInfo* gamepad,
+                           const js_event* events, size_t count,
+                           uint64_t first_sequence) {
+    if (*open &&
+        !_post_events(port, post, gamepad, events, count, first_sequence)) {
+      // The isolate is gone (e.g. after a hot restart), so the port will
+      // never be closed from Dart. Listeners can't be removed from their own
+      // callbacks, and removing it may stop this very reader thread, so close
+      // it from another thread.
+      if (open->exchange(false)) {
+        std::thread(gamepads_linux_close_port, handle->load()).detach();
+      }
+    }
+  };
+  input_core::ListenerId listener_id = core->add_listener(listener);
+  *handle = static_cast<int64_t>(listener_id);
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  _ports[*handle] = {core, listener_id};
+  return *handle;
+}
+
+void gamepads_linux_close_port(int64_t handle) {
+  OpenPort closed;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto port = _ports.find(handle);
+    if (port == _ports.end()) {
+      return;
+    }
+    closed = std::move(port->second);
+    _ports.erase(port);
+  }
+  closed.core->remove_listener(closed.listener_id);
+}
+
+namespace native_port {
+
+bool is_port_handle(int64_t handle) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _ports.count(handle) > 0;
+}
+
+uint64_t batch_pool_misses() {
+  return _pool_misses;
+}
+
+}  // namespace native_port
@@ -0,0 +1,56 @@
+#ifndef GAMEPADS_LINUX_NATIVE_PORT_H_
+#define GAMEPADS_LINUX_NATIVE_PORT_H_
+
+#include <cstdint>
+
+#include "include/gamepads_linux/gamepads_linux_plugin.h"
+
+/**
+ * Delivery of events straight to a Dart `SendPort`, bypassing the method
+ * channel. Looked up by the Dart side through `dart:ffi`.
+ *
+ * Events are posted from the reader threads, one message per read: a list
+ * with the gamepad id, an external `Uint8List` holding the events as 8-byte
+ * `js_event` records, followed by one byte per event with its
+ * [mappings::standard_index], and the sequence number of the first event
+ * (the others follow consecutively).
+ *
+ * The events are copied to batches preallocated for each reader thread, which
+ * return to it once Dart collected them.
+ */
+extern "C" {
+/**
+ * Registers [port] to receive events, posted using [post_cobject], which
+ * must be `Dart_PostCObject` (`NativeApi.postCObject` on the Dart side).
+ *
+ * Nothing is posted until gamepads are subscribed to through the
+ * `setEventsEnabled` method, passing the returned handle as `port`.
+ *
+ * Returns a handle for [gamepads_linux_close_port], or -1 if native ports
+ * are disabled with `GAMEPADS_NATIVE_PORTS=0`.
+ */
+FLUTTER_PLUGIN_EXPORT int64_t gamepads_linux_open_port(int64_t port,
+                                                       void* post_cobject);
+
+// Stops posting to the port opened with the given handle.
+FLUTTER_PLUGIN_EXPORT void gamepads_linux_close_port(int64_t handle);
+}
+
+namespace native_port {
+
+/**
+ * Whether [handle] was returned by [gamepads_linux_open_port] and is still
+ * open, as opposed to any other listener id.
+ */
+bool is_port_handle(int64_t handle);
+
+/**
+ * Number of batches allocated on their own since the start, because the pool
+ * of their reader was empty (Dart still holding all of its batches) or they
+ * were too large for it.
+ */
+uint64_t batch_pool_misses();
+
+}  // namespace native_port
+
+#endif  // GAMEPADS_LINUX_NATIVE_PORT_H_
@@ -0,0 +1,187 @@
+#include <linux/joystick.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "patterns.h"
+
+static uint64_t _bit(uint8_t button) {
+  return uint64_t{1} << button;
+}
+
+/**
+ * How long before [now] an event at [time] happened, in milliseconds.
+ *
+ * Event timestamps wrap around (5 minutes after boot, then every ~49 days),
+ * so they are only compared through their difference modulo 2^32.
+ */
+static uint32_t _age(uint32_t time, uint32_t now) {
+  return now - time;
+}
+
+/**
+ * Computes the KMP failure function of a sequence, so a partial match can
+ * fall back to the longest prefix that is still matching.
+ */
+static std::vector<size_t> _failure_function(
+    const std::vector<uint8_t>& buttons) {
+  std::vector<size_t> failure(buttons.size(), 0);
+  size_t length = 0;
+  for (size_t i = 1; i < buttons.size(); i++) {
+    while (length > 0 && buttons[i] != buttons[length]) {
+      length = failure[length - 1];
+    }
+    if (buttons[i] == buttons[length]) {
+      length++;
+    }
+    failure[i] = length;
+  }
+  return failure;
+}
+
+namespace patterns {
+PatternSet::PatternSet(std::vector<Pattern> patterns)
+    : patterns_(std::move(patterns)) {
+  for (const Pattern& pattern : patterns_) {
+    uint64_t mask = 0;
+    for (uint8_t button : pattern.buttons) {
+      mask |= _bit(button);
+    }
+    masks_.push_back(mask);
+    used_buttons_ |= mask;
+
+    if (pattern.type == PatternType::CHORD) {
+      failures_.emplace_back();
+    } else {
+      failures_.push_back(_failure_function(pattern.buttons));
+    }
+  }
+}
+
+Registry::Registry()
+    : current_(std::make_shared<PatternSet>(std::vector<Pattern>())) {}
+
+void Registry::add(Pattern pattern) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::erase_if(patterns_, [&](const Pattern& existing) {
+    return existing.owner == pattern.owner && existing.id == pattern.id;
+  });
+  patterns_.push_back(std::move(pattern));
+  current_ = std::make_shared<PatternSet>(patterns_);
+}
+
+bool Registry::remove(uint64_t owner, const std::string& id) {
+  return remove_if([&](const Pattern& existing) {
+    return existing.owner == owner && existing.id == id;
+  });
+}
+
+void Registry::remove_owner(uint64_t owner) {
+  remove_if([&](const Pattern& existing) { return existing.owner == owner; });
+}
+
+bool Registry::remove_if(
+    const std::function<bool(const Pattern&)>& predicate) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (std::erase_if(patterns_, predicate) == 0) {
+    return false;
+  }
+  current_ = std::make_shared<PatternSet>(patterns_);
+  return true;
+}
+
+std::shared_ptr<const PatternSet> Registry::current() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return current_;
+}
+
+void Matcher::reset(const std::shared_ptr<const PatternSet>& set) {
+  set_ = set;
+  size_t size = set->patterns_.size();
+  chords_fired_.assign(size, false);
+  progress_.assign(size, 0);
+  last_press_times_.assign(size, 0);
+  matches_.reserve(size);
+}
+
+void Matcher::clear() {
+  pressed_ = 0;
+  std::fill(chords_fired_.begin(), chords_fired_.end(), false);
+  std::fill(progress_.begin(), progress_.end(), 0);
+}
+
+const std::vector<const Pattern*>& Matcher::process(
+    const std::shared_ptr<const PatternSet>& set,
+    const js_event& event) {
+  matches_.clear();
+  if ((event.type & ~JS_EVENT_INIT) != JS_EVENT_BUTTON ||
+      event.number >= max_buttons) {
+    return matches_;
+  }
+  if (set != set_) {
+    reset(set);
+  }
+
+  uint64_t bit = _bit(event.number);
+  if (event.value == 0) {
+    pressed_ &= ~bit;
+    for (size_t i = 0; i < set_->patterns_.size(); i++) {
+      if (set_->masks_[i] & bit) {
+        chords_fired_[i] = false;
+      }
+    }
+    return matches_;
+  }
+
+  pressed_ |= bit;
+  press_times_[event.number] = event.time;
+  // The initial state replayed on connection is not a press.
+  if ((event.type & JS_EVENT_INIT) || !(set_->used_buttons_ & bit)) {
+    return matches_;
+  }
+
+  for (size_t i = 0; i < set_->patterns_.size(); i++) {
+    const Pattern& pattern = set_->patterns_[i];
+    uint64_t mask = set_->masks_[i];
+    if (!(mask & bit)) {
+      continue;
+    }
+
+    if (pattern.type == PatternType::CHORD) {
+      if (chords_fired_[i] || (pressed_ & mask) != mask) {
+        continue;
+      }
+      uint32_t oldest_press = 0;
+      for (uint8_t button : pattern.buttons) {
+        oldest_press =
+            std::max(oldest_press, _age(press_times_[button], event.time));
+      }
+      if (oldest_press <= pattern.window_ms) {
+        chords_fired_[i] = true;
+        matches_.push_back(&pattern);
+      }
+      continue;
+    }
+
+    size_t progress = progress_[i];
+    if (progress > 0 &&
+        _age(last_press_times_[i], event.time) > pattern.window_ms) {
+      progress = 0;
+    }
+    const std::vector<size_t>& failure = set_->failures_[i];
+    while (progress > 0 && pattern.buttons[progress] != event.number) {
+      progress = failure[progress - 1];
+    }
+    if (pattern.buttons[progress] == event.number) {
+      progress++;
+    }
+    if (progress == pattern.buttons.size()) {
+      matches_.push_back(&pattern);
+      progress = 0;
+    }
+    progress_[i] = progress;
+    last_press_times_[i] = event.time;
+  }
+  return matches_;
+}
+}  // namespace patterns
@@ -0,0 +1,116 @@
+#ifndef GAMEPADS_LINUX_PATTERNS_H_
+#define GAMEPADS_LINUX_PATTERNS_H_
+
+#include <linux/joystick.h>
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * Detects button chords and sequences natively, so listeners interested only
+ * in those don't need to receive every single event.
+ */
+namespace patterns {
+// Buttons are tracked in a 64-bit mask, so only the first 64 can be used.
+constexpr size_t max_buttons = 64;
+
+enum class PatternType {
+  // All buttons pressed within [Pattern::window_ms] of each other.
+  CHORD,
+  // Buttons pressed in order, at most [Pattern::window_ms] apart.
+  SEQUENCE,
+};
+
+struct Pattern {
+  // Who registered the pattern; ids only need to be unique per owner.
+  uint64_t owner;
+  std::string id;
+  PatternType type;
+  std::vector<uint8_t> buttons;
+  uint32_t window_ms;
+};
+
+/**
+ * An immutable, compiled set of patterns shared by all devices.
+ */
+class PatternSet {
+ public:
+  explicit PatternSet(std::vector<Pattern> patterns);
+
+  bool empty() const { return patterns_.empty(); }
+
+ private:
+  friend class Matcher;
+
+  std::vector<Pattern> patterns_;
+  // Buttons used by each pattern.
+  std::vector<uint64_t> masks_;
+  // KMP failure function of each sequence; empty for chords.
+  std::vector<std::vector<size_t>> failures_;
+  // Union of the buttons used by any pattern, to skip unrelated events.
+  uint64_t used_buttons_ = 0;
+};
+
+/**
+ * Thread-safe holder of the registered patterns.
+ */
+class Registry {
+ public:
+  Registry();
+
+  // Adds a pattern, replacing any existing one with the same owner and id.
+  void add(Pattern pattern);
+
+  // Returns false if no pattern with the given owner and id was registered.
+  bool remove(uint64_t owner, const std::string& id);
+
+  void remove_owner(uint64_t owner);
+
+  std::shared_ptr<const PatternSet> current() const;
+
+ private:
+  bool remove_if(const std::function<bool(const Pattern&)>& predicate);
+
+  mutable std::mutex mutex_;
+  std::vector<Pattern> patterns_;
+  std::shared_ptr<const PatternSet> current_;
+};
+
+/**
+ * The per-device state machine that runs the patterns over button events.
+ */
+class Matcher {
+ public:
+  /**
+   * Runs the patterns over an event, returning the ones it completes.
+   *
+   * The result is only valid until the next call; it is kept in storage
+   * reused between calls, so processing events doesn't allocate.
+   */
+  const std::vector<const Pattern*>& process(
+      const std::shared_ptr<const PatternSet>& set,
+      const js_event& event);
+
+  // Forgets the pressed buttons and partial matches, e.g. once the device
+  // is closed, as its state is replayed when it is opened again.
+  void clear();
+
+ private:
+  void reset(const std::shared_ptr<const PatternSet>& set);
+
+  std::shared_ptr<const PatternSet> set_;
+  uint64_t pressed_ = 0;
+  std::array<uint32_t, max_buttons> press_times_ = {};
+  std::vector<bool> chords_fired_;
+  std::vector<size_t> progress_;
+  std::vector<uint32_t> last_press_times_;
+  std::vector<const Pattern*> matches_;
+};
+}  // namespace patterns
+
+#endif  // GAMEPADS_LINUX_PATTERNS_H_
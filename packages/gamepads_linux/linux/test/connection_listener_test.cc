@@ -0,0 +1,137 @@
+/**
+ * Unit tests of the detection of joystick nodes.
+ *
+ * Watches a temporary directory, creating FIFOs and regular files in it
+ * before and after the listener starts, and checks that only the node types
+ * accepted by the listener's filter are reported, however they appeared.
+ */
+#include <fcntl.h>
+#include <sys/eventfd.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+
+#include "connection_listener.h"
+#include "test_utils.h"
+
+using namespace test_utils;
+
+/**
+ * What the listener did, on its thread.
+ */
+struct Observed {
+  std::mutex mutex;
+  std::condition_variable condition;
+  // Number of nodes whose type was checked.
+  int checked = 0;
+  std::set<std::string> connected;
+};
+
+static void create_file(const std::string& path) {
+  int fd = open(path.c_str(), O_CREAT | O_WRONLY | O_CLOEXEC, 0600);
+  if (fd != -1) {
+    close(fd);
+  }
+}
+
+static void wait_for_checks(Observed& observed, int count) {
+  std::unique_lock<std::mutex> lock(observed.mutex);
+  observed.condition.wait_for(lock, timeout,
+                              [&]() { return observed.checked >= count; });
+}
+
+/**
+ * Lists [input_dir] (holding 3 nodes) and watches it with the given filter,
+ * creating 2 FIFOs and 2 regular files once the listing is done, then returns
+ * the nodes reported as connected.
+ */
+static std::set<std::string> run_listener(
+    const std::string& input_dir,
+    const connection_listener::NodeTypeFilter& is_node_type) {
+  Observed observed;
+  std::atomic<bool> keep_reading = true;
+  int wake_fd = eventfd(0, EFD_CLOEXEC);
+  std::thread listener([&]() {
+    connection_listener::listen(
+        input_dir,
+        [&](unsigned char type) {
+          std::lock_guard<std::mutex> lock(observed.mutex);
+          observed.checked++;
+          observed.condition.notify_all();
+          return is_node_type(type);
+        },
+        &keep_reading, wake_fd,
+        [&](const connection_listener::ConnectionEvent& event) {
+          std::lock_guard<std::mutex> lock(observed.mutex);
+          if (event.type ==
+              connection_listener::ConnectionEventType::CONNECTED) {
+            observed.connected.insert(event.device_id);
+          }
+        });
+  });
+
+  // The directory is watched before being listed, so anything created from
+  // now on goes through inotify.
+  wait_for_checks(observed, 3);
+  mkfifo((input_dir + "js_fifo_created").c_str(), 0600);
+  create_file(input_dir + "js_file_created");
+  mkfifo((input_dir + "js_fifo_created_2").c_str(), 0600);
+  create_file(input_dir + "js_file_created_2");
+  wait_for_checks(observed, 7);
+
+  keep_reading = false;
+  eventfd_write(wake_fd, 1);
+  listener.join();
+  close(wake_fd);
+
+  unlink((input_dir + "js_fifo_created").c_str());
+  unlink((input_dir + "js_file_created").c_str());
+  unlink((input_dir + "js_fifo_created_2").c_str());
+  unlink((input_dir + "js_file_created_2").c_str());
+  return observed.connected;
+}
+
+int main() {
+  char dir_template[] = "/tmp/gamepads-connections-XXXXXX";
+  if (!mkdtemp(dir_template)) {
+    std::printf("Failed to create temp dir: %s\n", strerror(errno));
+    return 1;
+  }
+  std::string input_dir = std::string(dir_template) + "/";
+  mkfifo((input_dir + "js_fifo").c_str(), 0600);
+  mkfifo((input_dir + "js_fifo_2").c_str(), 0600);
+  create_file(input_dir + "js_file");
+
+  // The listener logs every connection; keep the output readable.
+  std::streambuf* cout_buffer = std::cout.rdbuf(nullptr);
+
+  std::set<std::string> fifos =
+      run_listener(input_dir, connection_listener::is_fifo);
+  expect(fifos == std::set<std::string>{input_dir + "js_fifo",
+                                        input_dir + "js_fifo_2",
+                                        input_dir + "js_fifo_created",
+                                        input_dir + "js_fifo_created_2"},
+         "the nodes reported are not the FIFOs, listed and created later");
+
+  std::set<std::string> devices =
+      run_listener(input_dir, connection_listener::is_character_device);
+  expect(devices.empty(),
+         "nodes other than character devices were reported by default");
+
+  std::cout.rdbuf(cout_buffer);
+  unlink((input_dir + "js_fifo").c_str());
+  unlink((input_dir + "js_fifo_2").c_str());
+  unlink((input_dir + "js_file").c_str());
+  rmdir(dir_template);
+
+  return finish("connection listener");
+}
@@ -0,0 +1,102 @@
+/**
+ * Unit tests of the per-gamepad input history.
+ *
+ * joydev timestamps start 5 minutes before they wrap around, and pass 2^31
+ * after ~24.8 days, so the history is checked around both points.
+ */
+#include <linux/joystick.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "history.h"
+#include "test_utils.h"
+
+using namespace test_utils;
+
+// Timestamp of the first events after boot (`INITIAL_JIFFIES`).
+static constexpr uint32_t _boot_time = 0xFFFFFFFFu - 300000 + 1;
+
+static void append_every_ms(history::Ring& ring,
+                            uint32_t start,
+                            uint32_t step,
+                            int count) {
+  for (int i = 0; i < count; i++) {
+    ring.append({start + static_cast<uint32_t>(i) * step, 1, JS_EVENT_BUTTON,
+                 static_cast<uint8_t>(i)});
+  }
+}
+
+static std::vector<js_event> copy_since(const history::Ring& ring,
+                                        uint32_t since_ms) {
+  std::vector<js_event> events;
+  ring.copy_since(since_ms, events);
+  return events;
+}
+
+static void test_after_boot() {
+  history::Ring ring;
+  ring.configure({16, 0});
+  append_every_ms(ring, _boot_time, 100, 8);
+
+  expect(copy_since(ring, 0).size() == 8,
+         "no since after boot did not return the whole history");
+  std::vector<js_event> events = copy_since(ring, _boot_time + 250);
+  expect(events.size() == 5 && events.front().time == _boot_time + 300,
+         "since after boot did not return the newer events");
+}
+
+static void test_across_wrap() {
+  history::Ring ring;
+  ring.configure({16, 0});
+  // Four events before timestamps wrap, four after.
+  append_every_ms(ring, 0xFFFFFFFFu - 349, 100, 8);
+
+  expect(copy_since(ring, 0).size() == 8,
+         "no since across the wrap did not return the whole history");
+  std::vector<js_event> events = copy_since(ring, 0xFFFFFFFFu - 200);
+  expect(events.size() == 6 && events.front().number == 2,
+         "since before the wrap did not return the events after it");
+  events = copy_since(ring, 10);
+  expect(events.size() == 4 && events.front().number == 4,
+         "since after the wrap did not return the newer events");
+  expect(copy_since(ring, 1000).empty(),
+         "since after the latest event returned events");
+}
+
+static void test_past_half_range() {
+  history::Ring ring;
+  ring.configure({16, 0});
+  uint32_t start = 0x80000000u + 1000;
+  append_every_ms(ring, start, 10, 4);
+
+  expect(copy_since(ring, 0).size() == 4,
+         "no since past 2^31 did not return the whole history");
+  expect(copy_since(ring, start - 0x40000000u).size() == 4,
+         "since days before the history did not return all of it");
+  expect(copy_since(ring, start + 15).size() == 2,
+         "since past 2^31 did not return the newer events");
+}
+
+static void test_limits() {
+  history::Ring ring;
+  ring.configure({4, 0});
+  append_every_ms(ring, _boot_time, 1, 6);
+  std::vector<js_event> events = copy_since(ring, 0);
+  expect(events.size() == 4 && events.front().number == 2,
+         "a full history did not drop its oldest events");
+
+  ring.configure({16, 250});
+  append_every_ms(ring, 0xFFFFFFFFu - 349, 100, 8);
+  events = copy_since(ring, 0);
+  expect(events.size() == 3 && events.front().number == 5,
+         "events older than the maximum age across the wrap were kept");
+}
+
+int main() {
+  test_after_boot();
+  test_across_wrap();
+  test_past_half_range();
+  test_limits();
+  return finish("history");
+}
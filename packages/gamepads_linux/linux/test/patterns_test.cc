@@ -0,0 +1,194 @@
+/**
+ * Unit tests of the native chord and sequence detection.
+ *
+ * Feeds hand-written button events to a [patterns::Matcher] and checks which
+ * patterns it reports.
+ */
+#include <linux/joystick.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "patterns.h"
+#include "test_utils.h"
+
+using namespace test_utils;
+
+static patterns::Pattern make_pattern(const std::string& id,
+                                      patterns::PatternType type,
+                                      std::vector<uint8_t> buttons,
+                                      uint32_t window_ms) {
+  return {1, id, type, std::move(buttons), window_ms};
+}
+
+static std::shared_ptr<const patterns::PatternSet> make_set(
+    std::vector<patterns::Pattern> patterns) {
+  return std::make_shared<patterns::PatternSet>(std::move(patterns));
+}
+
+/**
+ * Presses (or releases) a button, returning the ids of the patterns matched.
+ */
+static std::vector<std::string> press(
+    patterns::Matcher& matcher,
+    const std::shared_ptr<const patterns::PatternSet>& set,
+    uint32_t time,
+    uint8_t button,
+    int16_t value = 1,
+    uint8_t type = JS_EVENT_BUTTON) {
+  js_event event = {time, value, type, button};
+  std::vector<std::string> ids;
+  for (const patterns::Pattern* pattern : matcher.process(set, event)) {
+    ids.push_back(pattern->id);
+  }
+  return ids;
+}
+
+static void release(patterns::Matcher& matcher,
+                    const std::shared_ptr<const patterns::PatternSet>& set,
+                    uint32_t time,
+                    uint8_t button) {
+  press(matcher, set, time, button, 0);
+}
+
+static void test_chord_window() {
+  auto set = make_set(
+      {make_pattern("menu", patterns::PatternType::CHORD, {6, 7}, 100)});
+
+  patterns::Matcher matcher;
+  expect(press(matcher, set, 1000, 6).empty(), "chord matched too early");
+  expect(press(matcher, set, 1100, 7) == std::vector<std::string>{"menu"},
+         "chord within its window did not match");
+  expect(press(matcher, set, 1110, 7).empty(),
+         "held chord matched again without being released");
+
+  release(matcher, set, 1200, 7);
+  expect(press(matcher, set, 1250, 7).empty(),
+         "chord matched outside of its window");
+
+  release(matcher, set, 1300, 6);
+  release(matcher, set, 1300, 7);
+  expect(press(matcher, set, 1400, 7).empty(), "chord matched too early");
+  expect(press(matcher, set, 1401, 6) == std::vector<std::string>{"menu"},
+         "chord pressed in any order did not match");
+}
+
+static void test_chord_across_wrap() {
+  // Event timestamps wrap around 5 minutes after boot.
+  auto set = make_set(
+      {make_pattern("menu", patterns::PatternType::CHORD, {6, 7}, 100)});
+
+  patterns::Matcher matcher;
+  press(matcher, set, 0xfffffff0u, 6);
+  expect(press(matcher, set, 0x20, 7) == std::vector<std::string>{"menu"},
+         "chord within its window across the wrap did not match");
+
+  release(matcher, set, 0x30, 6);
+  release(matcher, set, 0x30, 7);
+  // Held since long before the wrap.
+  press(matcher, set, 0xffff0000u, 6);
+  expect(press(matcher, set, 0x10, 7).empty(),
+         "chord matched across the wrap outside of its window");
+}
+
+static void test_sequence_gaps() {
+  auto set = make_set(
+      {make_pattern("combo", patterns::PatternType::SEQUENCE, {0, 1, 2}, 50)});
+
+  patterns::Matcher matcher;
+  press(matcher, set, 1000, 0);
+  press(matcher, set, 1050, 1);
+  expect(press(matcher, set, 1100, 2) == std::vector<std::string>{"combo"},
+         "sequence within its window did not match");
+
+  press(matcher, set, 2000, 0);
+  press(matcher, set, 2051, 1);
+  expect(press(matcher, set, 2060, 2).empty(),
+         "sequence matched despite a gap longer than its window");
+
+  // After a gap, the late press may start the sequence over.
+  press(matcher, set, 3000, 0);
+  press(matcher, set, 3100, 0);
+  press(matcher, set, 3110, 1);
+  expect(press(matcher, set, 3120, 2) == std::vector<std::string>{"combo"},
+         "sequence did not restart after a gap");
+}
+
+static void test_sequence_fallback() {
+  // A mismatch after "0 0" must fall back to the matching "0" prefix instead
+  // of starting over, so "0 0 0 1" still completes "0 0 1".
+  auto set = make_set(
+      {make_pattern("kmp", patterns::PatternType::SEQUENCE, {0, 0, 1}, 100)});
+
+  patterns::Matcher matcher;
+  press(matcher, set, 1000, 0);
+  press(matcher, set, 1010, 0);
+  press(matcher, set, 1020, 0);
+  expect(press(matcher, set, 1030, 1) == std::vector<std::string>{"kmp"},
+         "sequence did not fall back to its longest matching prefix");
+
+  // Buttons no pattern uses are skipped altogether.
+  press(matcher, set, 2000, 0);
+  press(matcher, set, 2010, 3);
+  press(matcher, set, 2020, 0);
+  expect(press(matcher, set, 2030, 1) == std::vector<std::string>{"kmp"},
+         "an unrelated button broke a sequence");
+}
+
+static void test_initial_state() {
+  auto set = make_set(
+      {make_pattern("menu", patterns::PatternType::CHORD, {6, 7}, 100)});
+
+  patterns::Matcher matcher;
+  expect(press(matcher, set, 1000, 6, 1, JS_EVENT_BUTTON | JS_EVENT_INIT)
+             .empty(),
+         "initial state was taken as a press");
+  expect(press(matcher, set, 1010, 7, 1, JS_EVENT_BUTTON | JS_EVENT_INIT)
+             .empty(),
+         "initial state was taken as a press");
+}
+
+static void test_clear() {
+  auto set = make_set(
+      {make_pattern("menu", patterns::PatternType::CHORD, {6, 7}, 100),
+       make_pattern("combo", patterns::PatternType::SEQUENCE, {0, 1}, 100)});
+
+  patterns::Matcher matcher;
+  press(matcher, set, 1000, 6);
+  press(matcher, set, 1000, 0);
+  // The device is closed with buttons held, so their release is never read.
+  matcher.clear();
+  expect(press(matcher, set, 1010, 7).empty(),
+         "chord matched with a button pressed before the device was closed");
+  expect(press(matcher, set, 1020, 1).empty(),
+         "sequence continued from before the device was closed");
+}
+
+static void test_new_set() {
+  auto combo = make_pattern("combo", patterns::PatternType::SEQUENCE, {0, 1},
+                            100);
+  auto set = make_set({combo});
+
+  patterns::Matcher matcher;
+  press(matcher, set, 1000, 0);
+  // Registering another pattern starts every sequence over.
+  set = make_set(
+      {combo, make_pattern("menu", patterns::PatternType::CHORD, {6, 7}, 100)});
+  expect(press(matcher, set, 1010, 1).empty(),
+         "sequence continued across pattern sets");
+  press(matcher, set, 1020, 0);
+  expect(press(matcher, set, 1030, 1) == std::vector<std::string>{"combo"},
+         "sequence did not match with the new pattern set");
+}
+
+int main() {
+  test_chord_window();
+  test_chord_across_wrap();
+  test_sequence_gaps();
+  test_sequence_fallback();
+  test_initial_state();
+  test_clear();
+  test_new_set();
+  return finish("pattern");
+}
@@ -0,0 +1,182 @@
+/**
+ * Tests of the state kept for each gamepad.
+ *
+ * Feeds a fake joystick node (a FIFO) to an [input_core::InputCore], replays
+ * an initial state with a button held, then presses and releases another one,
+ * checking that the listed state follows every event along with its sequence
+ * number, and that the held button counts towards a chord.
+ */
+#include <linux/joystick.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "input_core.h"
+#include "test_utils.h"
+
+using namespace test_utils;
+
+/**
+ * What the listener received, on the reader thread.
+ */
+struct Received {
+  std::mutex mutex;
+  std::condition_variable condition;
+  std::vector<uint64_t> event_sequences;
+  std::vector<uint64_t> batch_sequences;
+  int snapshots = 0;
+  int matches = 0;
+};
+
+/**
+ * The state of a gamepad as listed by the core.
+ */
+struct Listed {
+  std::vector<int16_t> buttons;
+  std::vector<int16_t> axes;
+  uint64_t sequence = 0;
+};
+
+static bool wait_for(Received& received, const std::function<bool()>& done) {
+  std::unique_lock<std::mutex> lock(received.mutex);
+  return received.condition.wait_for(lock, timeout, done);
+}
+
+static Listed list_gamepad(input_core::InputCore& core,
+                           const std::string& device_id) {
+  Listed listed;
+  core.for_each_gamepad([&](const gamepad::GamepadInfo& gamepad) {
+    if (gamepad.device_id == device_id) {
+      std::lock_guard<std::mutex> lock(gamepad.snapshot_mutex);
+      listed = {gamepad.snapshot.buttons, gamepad.snapshot.axes,
+                gamepad.snapshot.sequence};
+    }
+  });
+  return listed;
+}
+
+static void test_listed_state(input_core::InputCore& core,
+                              Received& received,
+                              const std::string& path) {
+  mkfifo(path.c_str(), 0600);
+  int writer = open_writer(path);
+  if (writer == -1) {
+    expect(false, "the core never opened the gamepad");
+    unlink(path.c_str());
+    return;
+  }
+
+  // Replay an initial state with button 0 held, like the kernel does.
+  write_event(writer, 0, 1, JS_EVENT_BUTTON | JS_EVENT_INIT);
+  write_event(writer, 1, -7, JS_EVENT_AXIS | JS_EVENT_INIT);
+  expect(wait_for(received, [&]() { return received.snapshots > 0; }),
+         "the initial state was not folded into a snapshot");
+
+  write_event(writer, 3, 1);
+  expect(wait_for(received,
+                  [&]() { return received.batch_sequences.size() == 1; }),
+         "the press was not delivered");
+  Listed pressed = list_gamepad(core, path);
+  expect(pressed.buttons.size() > 3 && pressed.buttons[3] == 1,
+         "the listed state does not include the press");
+  expect(pressed.buttons.size() > 0 && pressed.buttons[0] == 1 &&
+             pressed.axes.size() > 1 && pressed.axes[1] == -7,
+         "the listed state lost the initial state");
+
+  write_event(writer, 3, 0);
+  expect(wait_for(received,
+                  [&]() { return received.batch_sequences.size() == 2; }),
+         "the release was not delivered");
+  Listed released = list_gamepad(core, path);
+  expect(released.buttons.size() > 3 && released.buttons[3] == 0,
+         "the listed state does not include the release");
+
+  std::lock_guard<std::mutex> lock(received.mutex);
+  if (received.event_sequences.size() == 2) {
+    expect(pressed.sequence == received.event_sequences[0] &&
+               released.sequence == received.event_sequences[1],
+           "the listed state is not numbered after the last event");
+    expect(received.event_sequences[0] < received.event_sequences[1],
+           "events are not numbered in order");
+  }
+  expect(received.batch_sequences == received.event_sequences,
+         "batches are numbered differently than their events");
+  expect(received.matches == 1,
+         "a button held when the gamepad was opened did not count towards a "
+         "chord");
+
+  close(writer);
+  unlink(path.c_str());
+}
+
+int main() {
+  char dir_template[] = "/tmp/gamepads-snapshot-XXXXXX";
+  if (!mkdtemp(dir_template)) {
+    std::printf("Failed to create temp dir: %s\n", strerror(errno));
+    return 1;
+  }
+  std::string input_dir = std::string(dir_template) + "/";
+
+  // The core logs every connection; keep the output readable.
+  std::streambuf* cout_buffer = std::cout.rdbuf(nullptr);
+  std::streambuf* cerr_buffer = std::cerr.rdbuf(nullptr);
+
+  input_core::Options options;
+  options.input_dir = input_dir;
+  options.open_device = open_fifo;
+  options.is_node_type = connection_listener::is_fifo;
+  input_core::InputCore core(options);
+
+  Received received;
+  input_core::Listener listener;
+  listener.on_event = [&](gamepad::GamepadInfo*, const js_event&,
+                          uint64_t sequence) {
+    std::lock_guard<std::mutex> lock(received.mutex);
+    received.event_sequences.push_back(sequence);
+  };
+  listener.on_events = [&](gamepad::GamepadInfo*, const js_event*,
+                           size_t count, uint64_t first_sequence) {
+    std::lock_guard<std::mutex> lock(received.mutex);
+    for (size_t i = 0; i < count; i++) {
+      received.batch_sequences.push_back(first_sequence + i);
+    }
+    received.condition.notify_all();
+  };
+  listener.on_snapshot = [&](gamepad::GamepadInfo*, bool connected) {
+    std::lock_guard<std::mutex> lock(received.mutex);
+    if (!connected) {
+      received.snapshots++;
+      received.condition.notify_all();
+    }
+  };
+  listener.on_pattern_matched = [&](gamepad::GamepadInfo*,
+                                    const patterns::Pattern&,
+                                    const js_event&) {
+    std::lock_guard<std::mutex> lock(received.mutex);
+    received.matches++;
+  };
+  input_core::ListenerId listener_id = core.add_listener(listener);
+  core.subscribe(listener_id);
+  core.add_pattern({listener_id, "menu", patterns::PatternType::CHORD, {0, 3},
+                    10000});
+  core.start();
+
+  test_listed_state(core, received, input_dir + "js0");
+
+  core.stop();
+  rmdir(dir_template);
+
+  std::cout.rdbuf(cout_buffer);
+  std::cerr.rdbuf(cerr_buffer);
+
+  return finish("snapshot");
+}
@@ -0,0 +1,349 @@
+/**
+ * Hotplug churn soak test.
+ *
+ * Creates and deletes thousands of fake joystick nodes (FIFOs) in a temporary
+ * directory watched by an [InputCore], while another node keeps streaming
+ * events, and checks that the number of threads, open file descriptors and
+ * the resident memory stay flat. Also reports the latency from creating a
+ * node until its first event is delivered, and checks that a second listener
+ * gets every event of the streaming node too, and that the initial state it
+ * replays ends up in its snapshot rather than being delivered as events.
+ * Finally checks that a gamepad stays listed, but is no longer read, once
+ * nobody subscribes to it.
+ *
+ * The number of connect/disconnect cycles can be set with the
+ * `GAMEPADS_SOAK_CYCLES` environment variable.
+ */
+#include <dirent.h>
+#include <fcntl.h>
+#include <linux/joystick.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "input_core.h"
+#include "latency_stats.h"
+#include "test_utils.h"
+
+using namespace std::chrono_literals;
+using namespace test_utils;
+
+static constexpr int _default_cycles = 2000;
+static constexpr int _warmup_cycles = 100;
+// Distinct node names the cycles rotate through, like real hotplugs do.
+static constexpr int _node_names = 4;
+static constexpr int _events_per_cycle = 16;
+static constexpr size_t _rss_tolerance_kb = 4096;
+
+struct Resources {
+  size_t threads;
+  size_t file_descriptors;
+  size_t rss_kb;
+};
+
+/**
+ * Records when the first event of the device under test was delivered.
+ */
+struct Tracker {
+  std::mutex mutex;
+  std::condition_variable condition;
+  std::string device_id;
+  std::optional<uint64_t> first_event_ns;
+  std::atomic<uint64_t> streamed_events = 0;
+  std::atomic<uint64_t> fanned_out_events = 0;
+  std::atomic<uint64_t> snapshots = 0;
+  std::atomic<uint64_t> leaked_initial_events = 0;
+};
+
+static size_t count_entries(const char* path) {
+  DIR* dir = opendir(path);
+  if (!dir) {
+    return 0;
+  }
+  size_t count = 0;
+  while (struct dirent* entry = readdir(dir)) {
+    if (entry->d_name[0] != '.') {
+      count++;
+    }
+  }
+  closedir(dir);
+  return count;
+}
+
+static size_t rss_kb() {
+  FILE* file = fopen("/proc/self/statm", "r");
+  if (!file) {
+    return 0;
+  }
+  size_t size = 0;
+  size_t resident = 0;
+  if (fscanf(file, "%zu %zu", &size, &resident) != 2) {
+    resident = 0;
+  }
+  fclose(file);
+  return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+static Resources sample_resources() {
+  return {count_entries("/proc/self/task"), count_entries("/proc/self/fd"),
+          rss_kb()};
+}
+
+static int cycles_from_env() {
+  const char* value = std::getenv("GAMEPADS_SOAK_CYCLES");
+  return value ? std::atoi(value) : _default_cycles;
+}
+
+static bool is_connected(input_core::InputCore& core, const std::string& id) {
+  bool connected = false;
+  core.for_each_gamepad([&](const gamepad::GamepadInfo& gamepad) {
+    connected = connected || gamepad.device_id == id;
+  });
+  return connected;
+}
+
+/**
+ * Connects a node, streams a few events through it and disconnects it.
+ *
+ * Returns the latency until the first event was delivered.
+ */
+static std::optional<uint64_t> run_cycle(input_core::InputCore& core,
+                                         Tracker& tracker,
+                                         const std::string& path) {
+  {
+    std::lock_guard<std::mutex> lock(tracker.mutex);
+    tracker.device_id = path;
+    tracker.first_event_ns.reset();
+  }
+  uint64_t created_ns = latency_stats::now_ns();
+  if (mkfifo(path.c_str(), 0600) != 0) {
+    std::printf("Failed to create %s: %s\n", path.c_str(), strerror(errno));
+    return std::nullopt;
+  }
+
+  int writer = open_writer(path);
+  if (writer == -1) {
+    std::printf("Core never opened %s\n", path.c_str());
+    unlink(path.c_str());
+    return std::nullopt;
+  }
+  for (int i = 0; i < _events_per_cycle; i++) {
+    write_event(writer, 0, i % 2);
+  }
+
+  std::optional<uint64_t> latency;
+  {
+    std::unique_lock<std::mutex> lock(tracker.mutex);
+    bool delivered = tracker.condition.wait_for(
+        lock, timeout, [&]() { return tracker.first_event_ns.has_value(); });
+    if (delivered) {
+      latency = *tracker.first_event_ns - created_ns;
+    }
+    tracker.device_id.clear();
+  }
+
+  unlink(path.c_str());
+  close(writer);
+
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (is_connected(core, path) &&
+         std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(50us);
+  }
+  return latency;
+}
+
+static uint64_t percentile_us(const std::vector<uint64_t>& sorted,
+                              double percentile) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  return sorted[static_cast<size_t>(percentile * (sorted.size() - 1))] / 1000;
+}
+
+int main() {
+  int cycles = cycles_from_env();
+
+  char dir_template[] = "/tmp/gamepads-soak-XXXXXX";
+  if (!mkdtemp(dir_template)) {
+    std::printf("Failed to create temp dir: %s\n", strerror(errno));
+    return 1;
+  }
+  std::string input_dir = std::string(dir_template) + "/";
+
+  // The core logs every connection; keep the output readable.
+  std::streambuf* cout_buffer = std::cout.rdbuf(nullptr);
+  std::streambuf* cerr_buffer = std::cerr.rdbuf(nullptr);
+
+  Tracker tracker;
+  input_core::Options options;
+  options.input_dir = input_dir;
+  options.open_device = open_fifo;
+  options.is_node_type = connection_listener::is_fifo;
+  std::string streaming_path = input_dir + "js_streaming";
+  input_core::InputCore core(options);
+  input_core::Listener listener;
+  listener.on_event = [&](gamepad::GamepadInfo* gamepad, const js_event& event,
+                          uint64_t) {
+    if (event.type & JS_EVENT_INIT) {
+      tracker.leaked_initial_events++;
+    }
+    if (gamepad->device_id == streaming_path) {
+      tracker.streamed_events++;
+      return;
+    }
+    std::lock_guard<std::mutex> lock(tracker.mutex);
+    if (gamepad->device_id == tracker.device_id && !tracker.first_event_ns) {
+      tracker.first_event_ns = latency_stats::now_ns();
+      tracker.condition.notify_all();
+    }
+  };
+  listener.on_snapshot = [&](gamepad::GamepadInfo* gamepad, bool connected) {
+    std::lock_guard<std::mutex> lock(gamepad->snapshot_mutex);
+    const std::vector<int16_t>& axes = gamepad->snapshot.axes;
+    if (gamepad->device_id == streaming_path && !connected &&
+        axes.size() > 2 && axes[2] == -7) {
+      tracker.snapshots++;
+    }
+  };
+  input_core::ListenerId listener_id = core.add_listener(listener);
+  core.subscribe(listener_id);
+
+  input_core::Listener second_listener;
+  second_listener.on_event = [&](gamepad::GamepadInfo* gamepad,
+                                 const js_event&, uint64_t) {
+    if (gamepad->device_id == streaming_path) {
+      tracker.fanned_out_events++;
+    }
+  };
+  input_core::ListenerId second_listener_id =
+      core.add_listener(second_listener);
+  core.subscribe(second_listener_id, streaming_path);
+  core.start();
+
+  // A gamepad that stays connected and busy during the whole run.
+  mkfifo(streaming_path.c_str(), 0600);
+  int streaming_writer = open_writer(streaming_path);
+  std::atomic<bool> streaming = streaming_writer != -1;
+  // Replay an initial state, like the kernel does when a device is opened.
+  write_event(streaming_writer, 0, 1, JS_EVENT_BUTTON | JS_EVENT_INIT);
+  write_event(streaming_writer, 2, -7, JS_EVENT_AXIS | JS_EVENT_INIT);
+  std::thread streamer([&]() {
+    int16_t value = 0;
+    while (streaming) {
+      write_event(streaming_writer, 1, value);
+      value = static_cast<int16_t>(value ^ 1);
+      std::this_thread::sleep_for(1ms);
+    }
+  });
+
+  bool passed = streaming;
+  std::vector<uint64_t> latencies;
+  Resources baseline = {};
+  for (int i = 0; i < _warmup_cycles + cycles && passed; i++) {
+    if (i == _warmup_cycles) {
+      baseline = sample_resources();
+    }
+    std::string path = input_dir + "js" + std::to_string(i % _node_names);
+    std::optional<uint64_t> latency = run_cycle(core, tracker, path);
+    if (!latency) {
+      std::printf("Cycle %d: no event delivered for %s\n", i, path.c_str());
+      passed = false;
+    } else if (i >= _warmup_cycles) {
+      latencies.push_back(*latency);
+    }
+  }
+
+  // Give the last disconnections a moment to be reaped.
+  Resources final = sample_resources();
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (final.threads > baseline.threads &&
+         std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(1ms);
+    final = sample_resources();
+  }
+
+  streaming = false;
+  streamer.join();
+
+  // Without subscribers the streaming gamepad's reader thread goes away.
+  Resources subscribed = sample_resources();
+  core.unsubscribe(listener_id);
+  core.unsubscribe(second_listener_id, streaming_path);
+  Resources unsubscribed = sample_resources();
+  bool still_listed = is_connected(core, streaming_path);
+
+  close(streaming_writer);
+  unlink(streaming_path.c_str());
+  core.stop();
+  rmdir(dir_template);
+
+  std::cout.rdbuf(cout_buffer);
+  std::cerr.rdbuf(cerr_buffer);
+
+  std::sort(latencies.begin(), latencies.end());
+  std::printf("Cycles: %zu\n", latencies.size());
+  std::printf("Streamed events: %llu\n",
+              static_cast<unsigned long long>(tracker.streamed_events));
+  std::printf(
+      "Connect-to-first-event: p50 %llu us, p99 %llu us, max %llu us\n",
+      static_cast<unsigned long long>(percentile_us(latencies, 0.5)),
+      static_cast<unsigned long long>(percentile_us(latencies, 0.99)),
+      static_cast<unsigned long long>(percentile_us(latencies, 1.0)));
+  std::printf("Fanned out events: %llu\n",
+              static_cast<unsigned long long>(tracker.fanned_out_events));
+  std::printf("Threads: %zu -> %zu\n", baseline.threads, final.threads);
+  std::printf("File descriptors: %zu -> %zu\n", baseline.file_descriptors,
+              final.file_descriptors);
+  std::printf("RSS: %zu KiB -> %zu KiB\n", baseline.rss_kb, final.rss_kb);
+  std::printf("Threads without subscribers: %zu -> %zu\n", subscribed.threads,
+              unsubscribed.threads);
+
+  if (final.threads > baseline.threads) {
+    std::printf("FAILED: thread count grew\n");
+    passed = false;
+  }
+  if (final.file_descriptors > baseline.file_descriptors) {
+    std::printf("FAILED: file descriptor count grew\n");
+    passed = false;
+  }
+  if (final.rss_kb > baseline.rss_kb + _rss_tolerance_kb) {
+    std::printf("FAILED: RSS grew by more than %zu KiB\n", _rss_tolerance_kb);
+    passed = false;
+  }
+  if (tracker.streamed_events == 0) {
+    std::printf("FAILED: the streaming gamepad delivered no events\n");
+    passed = false;
+  }
+  if (tracker.fanned_out_events != tracker.streamed_events) {
+    std::printf("FAILED: listeners received different events\n");
+    passed = false;
+  }
+  if (tracker.snapshots == 0 || tracker.leaked_initial_events != 0) {
+    std::printf("FAILED: the initial state was not folded into a snapshot\n");
+    passed = false;
+  }
+  if (unsubscribed.threads >= subscribed.threads ||
+      unsubscribed.file_descriptors >= subscribed.file_descriptors) {
+    std::printf("FAILED: an unused gamepad was still read\n");
+    passed = false;
+  }
+  if (!still_listed) {
+    std::printf("FAILED: an unused gamepad was no longer listed\n");
+    passed = false;
+  }
+  return passed ? 0 : 1;
+}
@@ -0,0 +1,80 @@
+#ifndef GAMEPADS_LINUX_TEST_TEST_UTILS_H_
+#define GAMEPADS_LINUX_TEST_TEST_UTILS_H_
+
+#include <fcntl.h>
+#include <linux/joystick.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+#include "latency_stats.h"
+
+/**
+ * Helpers shared by the native tests: reporting failures, and faking gamepads
+ * with FIFOs that the tests write events to.
+ */
+namespace test_utils {
+
+// How long to wait for the core to react, e.g. to open a gamepad.
+inline constexpr std::chrono::seconds timeout(2);
+
+// Whether every expectation held so far.
+inline bool passed = true;
+
+inline void expect(bool condition, const char* description) {
+  if (!condition) {
+    std::printf("FAILED: %s\n", description);
+    passed = false;
+  }
+}
+
+/**
+ * Reports whether all the tests of [name] passed, returning the exit status of
+ * the test executable.
+ */
+inline int finish(const char* name) {
+  if (passed) {
+    std::printf("All %s tests passed\n", name);
+  }
+  return passed ? 0 : 1;
+}
+
+// Opens a FIFO as a gamepad, in place of [gamepad::open_device].
+inline int open_fifo(const std::string& device_id) {
+  return open(device_id.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+}
+
+/**
+ * Opens the writing end of a FIFO, which only succeeds once the core opened
+ * the reading end.
+ */
+inline int open_writer(const std::string& path) {
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (std::chrono::steady_clock::now() < deadline) {
+    int writer = open(path.c_str(), O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+    if (writer != -1 || errno != ENXIO) {
+      return writer;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(50));
+  }
+  return -1;
+}
+
+// Writes an event timestamped now, returning whether it was written whole.
+inline bool write_event(int writer,
+                        uint8_t number,
+                        int16_t value,
+                        uint8_t type = JS_EVENT_BUTTON) {
+  js_event event = {latency_stats::to_event_time_ms(latency_stats::now_ns()),
+                    value, type, number};
+  return write(writer, &event, sizeof(event)) == sizeof(event);
+}
+
+}  // namespace test_utils
+
+#endif  // GAMEPADS_LINUX_TEST_TEST_UTILS_H_
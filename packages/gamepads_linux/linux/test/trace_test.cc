@@ -0,0 +1,132 @@
+/**
+ * Unit tests of the Chrome trace event output.
+ *
+ * Records events with known timestamps and checks how they are written, then
+ * stops and restarts tracing while another thread keeps recording, checking
+ * every trace written is complete. Also checks that threads exiting while
+ * tracing hand their buffers over to the next ones.
+ */
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "trace.h"
+#include "test_utils.h"
+
+using namespace test_utils;
+
+static std::string read_file(const std::string& path) {
+  std::ifstream file(path);
+  std::stringstream contents;
+  contents << file.rdbuf();
+  return contents.str();
+}
+
+static void test_timestamps(const std::string& path) {
+  trace::start(path);
+  // About 25 days of uptime, where 6 significant digits would only be
+  // precise to a few seconds.
+  trace::record_span("read", 2204271234567891, 2204271234570008);
+  trace::record_instant("connected");
+  expect(trace::stop() == path, "trace was not written");
+
+  std::string output = read_file(path);
+  expect(output.find("\"ts\":2204271234567.891,") != std::string::npos,
+         "span start is not written in exact microseconds");
+  expect(output.find("\"dur\":2.117}") != std::string::npos,
+         "span duration is not written in exact microseconds");
+  expect(output.find("\"name\":\"connected\"") != std::string::npos &&
+             output.find("\"ph\":\"i\"") != std::string::npos,
+         "instant was not written");
+
+  // Small values keep their leading zeros.
+  trace::start(path);
+  trace::record_span("read", 5, 1042);
+  trace::stop();
+  output = read_file(path);
+  expect(output.find("\"ts\":0.005,") != std::string::npos &&
+             output.find("\"dur\":1.037}") != std::string::npos,
+         "fractions are not padded");
+}
+
+static void test_disabled(const std::string& path) {
+  trace::record_span("read", 1000, 2000);
+  trace::start(path);
+  trace::stop();
+  expect(read_file(path).find("\"name\":\"read\"") == std::string::npos,
+         "an event recorded while tracing was disabled was written");
+}
+
+static void test_concurrent_stop(const std::string& path) {
+  std::atomic<bool> running = true;
+  std::thread recorder([&]() {
+    trace::set_thread_name("recorder");
+    while (running) {
+      trace::Span span("filter");
+    }
+  });
+
+  for (int i = 0; i < 200; i++) {
+    trace::start(path);
+    std::this_thread::yield();
+    trace::stop();
+    std::string output = read_file(path);
+    if (output.size() < 4 || output.compare(output.size() - 4, 4, "\n]}\n")) {
+      expect(false, "a trace stopped while recording is incomplete");
+      break;
+    }
+  }
+  running = false;
+  recorder.join();
+}
+
+static void test_exited_threads(const std::string& path) {
+  trace::start(path);
+  for (int i = 0; i < 20; i++) {
+    std::thread worker([i]() {
+      trace::set_thread_name("worker " + std::to_string(i));
+      trace::record_span("read", 1000, 2000);
+    });
+    worker.join();
+  }
+  trace::stop();
+
+  std::string output = read_file(path);
+  int workers = 0;
+  for (size_t found = output.find("\"name\":\"worker ");
+       found != std::string::npos;
+       found = output.find("\"name\":\"worker ", found + 1)) {
+    workers++;
+  }
+  expect(workers > 0 && workers <= 4,
+         "the buffers of exited threads were not reused");
+  expect(output.find("\"name\":\"worker 19\"") != std::string::npos,
+         "the last exited thread is missing from the trace");
+  expect(output.find("\"name\":\"worker 0\"") == std::string::npos,
+         "the oldest exited thread was kept over the newer ones");
+}
+
+int main() {
+  char path_template[] = "/tmp/gamepads-trace-XXXXXX";
+  int fd = mkstemp(path_template);
+  if (fd == -1) {
+    std::printf("Failed to create a temporary file\n");
+    return 1;
+  }
+  close(fd);
+  std::string path = path_template;
+
+  test_timestamps(path);
+  test_disabled(path);
+  test_concurrent_stop(path);
+  test_exited_threads(path);
+  unlink(path.c_str());
+
+  return finish("trace");
+}
@@ -0,0 +1,227 @@
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <array>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "trace.h"
+
+// Events kept per thread.
+static constexpr size_t _capacity = 8192;
+// Buffers of exited threads kept for their events until tracing stops; past
+// that, the oldest one is reused for the next thread instead of allocating.
+static constexpr size_t _max_retired = 4;
+
+struct TraceEvent {
+  const char* name;
+  // 'X' for spans, 'i' for instants.
+  char phase;
+  uint64_t start_ns;
+  uint64_t duration_ns;
+};
+
+/**
+ * A single-producer ring buffer, written only by its thread.
+ *
+ * The thread raises [writing] while it records, so [trace::stop] can wait for
+ * it to be done before reading the events.
+ */
+struct ThreadBuffer {
+  pid_t tid;
+  // Guarded by [_mutex].
+  std::string thread_name;
+  // Whether its thread exited; guarded by [_mutex].
+  bool retired = false;
+  std::array<TraceEvent, _capacity> events;
+  std::atomic<uint64_t> head = 0;
+  std::atomic<bool> writing = false;
+};
+
+static std::mutex _mutex;
+static std::vector<std::unique_ptr<ThreadBuffer>> _buffers;
+// Buffers of exited threads, oldest first; guarded by [_mutex].
+static std::deque<ThreadBuffer*> _retired;
+static std::string _path;
+
+/**
+ * Retires the buffer of the current thread when it exits, so that threads
+ * started while tracing (e.g. one per hotplugged gamepad) reuse the buffers
+ * of the ones gone rather than keep adding buffers until [trace::stop].
+ */
+struct BufferOwner {
+  ThreadBuffer* buffer = nullptr;
+
+  ~BufferOwner() {
+    if (buffer != nullptr) {
+      std::lock_guard<std::mutex> lock(_mutex);
+      buffer->retired = true;
+      _retired.push_back(buffer);
+    }
+  }
+};
+
+static thread_local BufferOwner _thread_buffer;
+static thread_local std::string _thread_name;
+
+static ThreadBuffer* _current_buffer() {
+  if (_thread_buffer.buffer == nullptr) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    ThreadBuffer* buffer;
+    if (_retired.size() >= _max_retired) {
+      // Drops the events of the oldest thread gone.
+      buffer = _retired.front();
+      _retired.pop_front();
+      buffer->retired = false;
+      buffer->head = 0;
+    } else {
+      _buffers.push_back(std::make_unique<ThreadBuffer>());
+      buffer = _buffers.back().get();
+    }
+    buffer->tid = static_cast<pid_t>(syscall(SYS_gettid));
+    buffer->thread_name = _thread_name;
+    _thread_buffer.buffer = buffer;
+  }
+  return _thread_buffer.buffer;
+}
+
+static void _record(const char* name,
+                    char phase,
+                    uint64_t start_ns,
+                    uint64_t duration_ns) {
+  ThreadBuffer* buffer = _current_buffer();
+  // Pairs with [trace::stop]: either it sees this write in progress and waits
+  // for it, or this sees tracing disabled and drops the event.
+  buffer->writing.store(true);
+  if (trace::enabled.load()) {
+    uint64_t head = buffer->head.load(std::memory_order_relaxed);
+    buffer->events[head % _capacity] = {name, phase, start_ns, duration_ns};
+    buffer->head.store(head + 1, std::memory_order_relaxed);
+  }
+  buffer->writing.store(false, std::memory_order_release);
+}
+
+// Writes a time in microseconds, keeping the nanoseconds as a fraction.
+static void _write_us(std::ostream& out, uint64_t ns) {
+  out << ns / 1000 << '.' << std::setw(3) << std::setfill('0') << ns % 1000;
+}
+
+static void _write_escaped(std::ostream& out, const std::string& value) {
+  for (char c : value) {
+    if (c == '"' || c == '\\') {
+      out << '\\';
+    }
+    out << c;
+  }
+}
+
+static void _write_trace(std::ostream& out) {
+  pid_t pid = getpid();
+  out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  bool first = true;
+  for (const std::unique_ptr<ThreadBuffer>& buffer : _buffers) {
+    if (!buffer->thread_name.empty()) {
+      out << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\","
+          << "\"pid\":" << pid << ",\"tid\":" << buffer->tid
+          << ",\"args\":{\"name\":\"";
+      _write_escaped(out, buffer->thread_name);
+      out << "\"}}";
+      first = false;
+    }
+
+    uint64_t head = buffer->head.load(std::memory_order_acquire);
+    uint64_t begin = head > _capacity ? head - _capacity : 0;
+    for (uint64_t i = begin; i < head; i++) {
+      const TraceEvent& event = buffer->events[i % _capacity];
+      out << (first ? "" : ",") << "\n{\"name\":\"" << event.name
+          << "\",\"cat\":\"gamepads\",\"ph\":\"" << event.phase
+          << "\",\"ts\":";
+      _write_us(out, event.start_ns);
+      out << ",\"pid\":" << pid << ",\"tid\":" << buffer->tid;
+      if (event.phase == 'X') {
+        out << ",\"dur\":";
+        _write_us(out, event.duration_ns);
+      } else {
+        out << ",\"s\":\"t\"";
+      }
+      out << "}";
+      first = false;
+    }
+  }
+  out << "\n]}\n";
+}
+
+namespace trace {
+void start(const std::string& path) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  _path = path;
+  enabled = true;
+}
+
+void start_from_env() {
+  const char* path = std::getenv("GAMEPADS_TRACE");
+  if (path == nullptr || *path == '\0' || is_enabled()) {
+    return;
+  }
+  start(path);
+  std::atexit([]() { stop(); });
+}
+
+std::optional<std::string> stop() {
+  if (!enabled.exchange(false)) {
+    return std::nullopt;
+  }
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  // Wait for the events being recorded; later ones are dropped, so the
+  // buffers can be read and reset safely.
+  for (const std::unique_ptr<ThreadBuffer>& buffer : _buffers) {
+    while (buffer->writing.load()) {
+      std::this_thread::yield();
+    }
+  }
+
+  std::ofstream file(_path);
+  _write_trace(file);
+  if (!file) {
+    std::cerr << "Failed to write trace to " << _path << std::endl;
+  }
+
+  // Drop the buffers of threads that are gone and start the others afresh.
+  std::erase_if(_buffers, [](const std::unique_ptr<ThreadBuffer>& buffer) {
+    return buffer->retired;
+  });
+  _retired.clear();
+  for (const std::unique_ptr<ThreadBuffer>& buffer : _buffers) {
+    buffer->head = 0;
+  }
+  return file ? std::optional<std::string>(_path) : std::nullopt;
+}
+
+void set_thread_name(const std::string& name) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  _thread_name = name;
+  if (_thread_buffer.buffer != nullptr) {
+    _thread_buffer.buffer->thread_name = name;
+  }
+}
+
+void record_span(const char* name, uint64_t start_ns, uint64_t end_ns) {
+  if (is_enabled()) {
+    _record(name, 'X', start_ns, end_ns - start_ns);
+  }
+}
+
+void record_instant(const char* name) {
+  if (is_enabled()) {
+    _record(name, 'i', latency_stats::now_ns(), 0);
+  }
+}
+}  // namespace trace
@@ -0,0 +1,74 @@
+#ifndef GAMEPADS_LINUX_TRACE_H_
+#define GAMEPADS_LINUX_TRACE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "latency_stats.h"
+
+/**
+ * Opt-in tracing of the input pipeline, written in the Chrome trace event
+ * format so it can be loaded in Perfetto next to the Flutter engine's own
+ * timeline (both use CLOCK_MONOTONIC).
+ *
+ * Every thread records into its own fixed-size ring buffer without locking;
+ * only the most recent events of each thread are kept. While tracing is
+ * disabled, recording costs a single branch. Events recorded while tracing is
+ * being stopped are dropped.
+ */
+namespace trace {
+inline std::atomic<bool> enabled = false;
+
+inline bool is_enabled() {
+  return __builtin_expect(enabled.load(std::memory_order_relaxed), 0);
+}
+
+// Starts tracing, to be written to [path] when stopped.
+void start(const std::string& path);
+
+// Starts tracing if `GAMEPADS_TRACE` is set to an output path, writing the
+// trace when the process exits.
+void start_from_env();
+
+// Stops tracing and writes the trace, returning the path written to.
+std::optional<std::string> stop();
+
+// Names the calling thread in the trace.
+void set_thread_name(const std::string& name);
+
+// Records a span; the name must be a string literal.
+void record_span(const char* name, uint64_t start_ns, uint64_t end_ns);
+
+// Records an instant event, e.g. a connection; the name must be a string
+// literal.
+void record_instant(const char* name);
+
+/**
+ * Records a span from its construction until it goes out of scope.
+ *
+ * The name must be a string literal.
+ */
+class Span {
+ public:
+  explicit Span(const char* name)
+      : name_(name), start_ns_(is_enabled() ? latency_stats::now_ns() : 0) {}
+
+  ~Span() {
+    if (start_ns_ != 0 && is_enabled()) {
+      record_span(name_, start_ns_, latency_stats::now_ns());
+    }
+  }
+
+  // Disallow copy and assign.
+  Span(const Span&) = delete;
+  Span& operator=(const Span&) = delete;
+
+ private:
+  const char* name_;
+  uint64_t start_ns_;
+};
+}  // namespace trace
+
+#endif  // GAMEPADS_LINUX_TRACE_H_
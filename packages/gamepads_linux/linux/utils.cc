@@ -1,8 +1,19 @@
+#include <cstdlib>
 #include <string>
 
+#include "utils.h"
+
 bool starts_with(const std::string& str, const std::string& prefix) {
   if (prefix.length() > str.length()) {
     return false;
   }
   return str.compare(0, prefix.length(), prefix) == 0;
-}
\ No newline at end of file
+}
+
+int int_from_env(const char* name, int fallback) {
+  const char* value = std::getenv(name);
+  if (value == nullptr || *value == '\0') {
+    return fallback;
+  }
+  return std::atoi(value);
+}
@@ -1,5 +1,13 @@
+#ifndef GAMEPADS_LINUX_UTILS_H_
+#define GAMEPADS_LINUX_UTILS_H_
+
 #include <memory>
 #include <stdexcept>
 #include <string>
 
-bool starts_with(const std::string& string, const std::string& prefix);
\ No newline at end of file
+bool starts_with(const std::string& string, const std::string& prefix);
+
+// Reads an integer environment variable, or [fallback] if it is not set.
+int int_from_env(const char* name, int fallback);
+
+#endif  // GAMEPADS_LINUX_UTILS_H_
@@ -0,0 +1,67 @@
+import 'dart:typed_data';
+
+import 'package:flutter_test/flutter_test.dart';
+import 'package:gamepads_linux/gamepads_linux.dart';
+import 'package:gamepads_platform_interface/api/gamepad_event.dart';
+
+void main() {
+  TestWidgetsFlutterBinding.ensureInitialized();
+
+  test('decodes the batches posted to the native port', () async {
+    // The native library is not available in tests, so the port is never
+    // opened, but batches can still be fed to the plugin.
+    final plugin = GamepadsLinux();
+    final events = plugin.gamepadEventsStream.take(3).toList();
+
+    final records = ByteData(3 * 8)
+      // A press of the south button.
+      ..setUint32(0, 100, Endian.host)
+      ..setInt16(4, 1, Endian.host)
+      ..setUint8(6, 0x01)
+      ..setUint8(7, 0)
+      // The left stick pushed all the way left.
+      ..setUint32(8, 120, Endian.host)
+      ..setInt16(12, -32768, Endian.host)
+      ..setUint8(14, 0x02)
+      ..setUint8(15, 1)
+      // A button without a standard key.
+      ..setUint32(16, 130, Endian.host)
+      ..setInt16(20, 0, Endian.host)
+      ..setUint8(22, 0x01)
+      ..setUint8(23, 12);
+    plugin.onBatch([
+      '/dev/input/js0',
+      Uint8List.fromList([
+        ...records.buffer.asUint8List(),
+        // Standard indices: south, leftX (axes follow the 11 buttons), none.
+        0,
+        11,
+        255,
+      ]),
+      40,
+    ]);
+
+    final [press, axis, unmapped] = await events;
+    expect(press.gamepadId, '/dev/input/js0');
+    expect(press.timestamp, 100);
+    expect(press.type, KeyType.button);
+    expect(press.key, '0');
+    expect(press.value, 1.0);
+    expect(press.standardKey, 'south');
+    expect(press.sequence, 40);
+
+    expect(axis.timestamp, 120);
+    expect(axis.type, KeyType.analog);
+    expect(axis.key, '1');
+    expect(axis.value, -32768.0);
+    expect(axis.standardKey, 'leftX');
+    expect(axis.sequence, 41);
+
+    expect(unmapped.key, '12');
+    expect(unmapped.value, 0.0);
+    expect(unmapped.standardKey, isNull);
+    expect(unmapped.sequence, 42);
+
+    await plugin.dispose();
+  });
+}
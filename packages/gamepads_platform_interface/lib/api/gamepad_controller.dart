@@ -1,14 +1,16 @@
 import 'dart:async';
 
 import 'package:gamepads_platform_interface/api/gamepad_event.dart';
+import 'package:gamepads_platform_interface/api/gamepad_snapshot.dart';
 import 'package:gamepads_platform_interface/api/gamepad_state.dart';
 import 'package:gamepads_platform_interface/gamepads_platform_interface.dart';
 
 /// Represents a single, currently connected joystick controller (or gamepad).
 ///
 /// By calling the constructor, this object will automatically subscribe to
-/// events and update its internal [state]. To stop listening, be sure to call
-/// [dispose]. Failing to do so may result in the object leaking memory.
+/// events and snapshots and update its internal [state]. To stop listening, be
+/// sure to call [dispose]. Failing to do so may result in the object leaking
+/// memory.
 class GamepadController {
   /// A unique identifier for the gamepad controller.
   ///
@@ -22,6 +24,7 @@ class GamepadController {
   final state = GamepadState();
 
   StreamSubscription<GamepadEvent>? _subscription;
+  StreamSubscription<GamepadSnapshot>? _snapshotSubscription;
 
   GamepadController({
     required this.id,
@@ -29,6 +32,7 @@ class GamepadController {
     required GamepadsPlatformInterface plugin,
   }) {
     _subscription = plugin.eventsByGamepad(id).listen(state.update);
+    _snapshotSubscription = plugin.snapshotsByGamepad(id).listen(state.seed);
   }
 
   factory GamepadController.parse(
@@ -37,12 +41,27 @@ class GamepadController {
   ) {
     final id = map['id'] as String;
     final name = map['name'] as String;
-    return GamepadController(id: id, name: name, plugin: plugin);
+    final controller = GamepadController(id: id, name: name, plugin: plugin);
+    if (map.containsKey('buttons') || map.containsKey('axes')) {
+      controller.state.seed(
+        GamepadSnapshot(
+          gamepadId: id,
+          name: name,
+          isConnection: false,
+          analogInputs: GamepadSnapshot.parseAnalogInputs(map),
+          buttonInputs: GamepadSnapshot.parseButtonInputs(map),
+          sequence: map['sequence'] as int?,
+        ),
+      );
+    }
+    return controller;
   }
 
   /// Stops listening for new inputs.
   Future<void> dispose() async {
     await _subscription?.cancel();
     _subscription = null;
+    await _snapshotSubscription?.cancel();
+    _snapshotSubscription = null;
   }
 }
@@ -35,12 +35,27 @@ class GamepadEvent {
   /// The current value of the key.
   final double value;
 
+  /// The input in the standard gamepad layout that [key] corresponds to, if
+  /// the platform recognizes the controller.
+  ///
+  /// Buttons are one of `south`, `east`, `west`, `north`, `leftShoulder`,
+  /// `rightShoulder`, `back`, `start`, `guide`, `leftStick` and `rightStick`.
+  /// Analog inputs are one of `leftX`, `leftY`, `rightX`, `rightY`,
+  /// `leftTrigger`, `rightTrigger`, `dpadX` and `dpadY`.
+  final String? standardKey;
+
+  /// Orders the event against `GamepadSnapshot.sequence`, for the platforms
+  /// that number them; later events have greater numbers.
+  final int? sequence;
+
   GamepadEvent({
     required this.gamepadId,
     required this.timestamp,
     required this.type,
     required this.key,
     required this.value,
+    this.standardKey,
+    this.sequence,
   });
 
   @override
@@ -54,6 +69,8 @@ class GamepadEvent {
     final type = KeyType.values.byName(map['type'] as String);
     final key = map['key'] as String;
     final value = map['value'] as double;
+    final standardKey = map['standardKey'] as String?;
+    final sequence = map['sequence'] as int?;
 
     return GamepadEvent(
       gamepadId: gamepadId,
@@ -61,6 +78,8 @@ class GamepadEvent {
       type: type,
       key: key,
       value: value,
+      standardKey: standardKey,
+      sequence: sequence,
     );
   }
 }
@@ -0,0 +1,61 @@
+import 'dart:typed_data';
+
+import 'package:gamepads_platform_interface/api/gamepad_event.dart';
+
+/// The most recent inputs of a gamepad, as kept by the platform, see
+/// `getHistory`.
+///
+/// The inputs are packed records read straight from [bytes], so no object is
+/// allocated per input unless [eventAt] is used.
+class GamepadHistory {
+  /// Size in bytes of each record.
+  static const int recordSize = 8;
+
+  static const int _buttonType = 0x01;
+
+  /// The id of the gamepad controller the inputs come from.
+  final String gamepadId;
+
+  /// The packed records: a 32-bit timestamp, a 16-bit value, an 8-bit type
+  /// and an 8-bit key each, in host byte order.
+  final Uint8List bytes;
+
+  final ByteData _data;
+
+  GamepadHistory(this.gamepadId, this.bytes)
+    : _data = ByteData.sublistView(bytes);
+
+  /// The number of inputs, oldest first.
+  int get length => bytes.length ~/ recordSize;
+
+  bool get isEmpty => length == 0;
+
+  /// The timestamp of the input at [index], comparable to
+  /// [GamepadEvent.timestamp].
+  int timestampAt(int index) =>
+      _data.getUint32(index * recordSize, Endian.host);
+
+  /// The value of the input at [index], as in [GamepadEvent.value].
+  double valueAt(int index) =>
+      _data.getInt16(index * recordSize + 4, Endian.host).toDouble();
+
+  KeyType typeAt(int index) {
+    final type = bytes[index * recordSize + 6];
+    return type == _buttonType ? KeyType.button : KeyType.analog;
+  }
+
+  /// The number identifying the key of the input at [index], i.e. the
+  /// numeric value of [GamepadEvent.key].
+  int keyAt(int index) => bytes[index * recordSize + 7];
+
+  /// Builds the [GamepadEvent] for the input at [index].
+  GamepadEvent eventAt(int index) {
+    return GamepadEvent(
+      gamepadId: gamepadId,
+      timestamp: timestampAt(index),
+      type: typeAt(index),
+      key: keyAt(index).toString(),
+      value: valueAt(index),
+    );
+  }
+}
@@ -0,0 +1,85 @@
+/// A button pattern detected natively, see `registerPattern`.
+///
+/// Keys use the same platform-dependant identifiers as `GamepadEvent.key`.
+sealed class GamepadPattern {
+  /// A unique identifier for the pattern, reported back on every match.
+  final String id;
+
+  /// The buttons making up the pattern.
+  final List<String> keys;
+
+  const GamepadPattern({required this.id, required this.keys});
+
+  Map<String, dynamic> toMap();
+}
+
+/// Matches when all [keys] are held down, having been pressed within
+/// [tolerance] of each other.
+class GamepadChord extends GamepadPattern {
+  final Duration tolerance;
+
+  const GamepadChord({
+    required super.id,
+    required super.keys,
+    this.tolerance = const Duration(milliseconds: 100),
+  });
+
+  @override
+  Map<String, dynamic> toMap() => <String, dynamic>{
+    'id': id,
+    'type': 'chord',
+    'buttons': keys,
+    'windowMs': tolerance.inMilliseconds,
+  };
+}
+
+/// Matches when [keys] are pressed in order, with at most [maxGap] between
+/// consecutive presses.
+class GamepadSequence extends GamepadPattern {
+  final Duration maxGap;
+
+  const GamepadSequence({
+    required super.id,
+    required super.keys,
+    this.maxGap = const Duration(milliseconds: 500),
+  });
+
+  @override
+  Map<String, dynamic> toMap() => <String, dynamic>{
+    'id': id,
+    'type': 'sequence',
+    'buttons': keys,
+    'windowMs': maxGap.inMilliseconds,
+  };
+}
+
+/// Represents a registered [GamepadPattern] being matched on a gamepad.
+class GamepadPatternMatch {
+  /// The id of the gamepad controller on which the pattern was matched.
+  final String gamepadId;
+
+  /// The [GamepadPattern.id] of the matched pattern.
+  final String patternId;
+
+  /// The timestamp of the event that completed the pattern.
+  final int timestamp;
+
+  GamepadPatternMatch({
+    required this.gamepadId,
+    required this.patternId,
+    required this.timestamp,
+  });
+
+  @override
+  String toString() {
+    return '[$gamepadId] $patternId';
+  }
+
+  factory GamepadPatternMatch.parse(Map<dynamic, dynamic> map) {
+    return GamepadPatternMatch(
+      gamepadId: map['gamepadId'] as String,
+      patternId: map['patternId'] as String,
+      timestamp: map['time'] as int,
+    );
+  }
+}
@@ -0,0 +1,68 @@
+import 'package:gamepads_platform_interface/api/gamepad_event.dart';
+
+/// The whole state of a gamepad at once, sent by the platform when it is
+/// connected or opened again, instead of one [GamepadEvent] per input.
+///
+/// Keys are the same as in [GamepadEvent.key].
+class GamepadSnapshot {
+  /// The id of the gamepad controller the state belongs to.
+  final String gamepadId;
+
+  /// A user-facing, platform-dependant name for the gamepad controller.
+  final String name;
+
+  /// Whether the gamepad was just connected, rather than opened again (e.g.
+  /// when something starts listening to it).
+  final bool isConnection;
+
+  /// The values of the inputs of type [KeyType.analog].
+  final Map<String, double> analogInputs;
+
+  /// Whether each input of type [KeyType.button] is pressed.
+  final Map<String, bool> buttonInputs;
+
+  /// The [GamepadEvent.sequence] of the last event included in the state, for
+  /// the platforms that number events.
+  ///
+  /// Snapshots and events may be delivered separately, so this tells which
+  /// events arrived before the snapshot they are already part of.
+  final int? sequence;
+
+  const GamepadSnapshot({
+    required this.gamepadId,
+    required this.name,
+    required this.isConnection,
+    required this.analogInputs,
+    required this.buttonInputs,
+    this.sequence,
+  });
+
+  factory GamepadSnapshot.parse(Map<dynamic, dynamic> map) {
+    return GamepadSnapshot(
+      gamepadId: map['gamepadId'] as String,
+      name: map['name'] as String,
+      isConnection: map['connected'] as bool? ?? false,
+      analogInputs: parseAnalogInputs(map),
+      buttonInputs: parseButtonInputs(map),
+      sequence: map['sequence'] as int?,
+    );
+  }
+
+  /// Reads the raw `axes` values of a platform message, indexed by key.
+  static Map<String, double> parseAnalogInputs(Map<dynamic, dynamic> map) {
+    final axes = (map['axes'] as List<Object?>?) ?? const [];
+    return {
+      for (var i = 0; i < axes.length; i++)
+        i.toString(): (axes[i]! as int).toDouble(),
+    };
+  }
+
+  /// Reads the raw `buttons` values of a platform message, indexed by key.
+  static Map<String, bool> parseButtonInputs(Map<dynamic, dynamic> map) {
+    final buttons = (map['buttons'] as List<Object?>?) ?? const [];
+    return {
+      for (var i = 0; i < buttons.length; i++)
+        i.toString(): (buttons[i]! as int) != 0,
+    };
+  }
+}
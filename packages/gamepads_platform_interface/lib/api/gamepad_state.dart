@@ -1,4 +1,5 @@
 import 'package:gamepads_platform_interface/api/gamepad_event.dart';
+import 'package:gamepads_platform_interface/api/gamepad_snapshot.dart';
 
 /// The current state of a gamepad.
 ///
@@ -6,6 +7,10 @@ import 'package:gamepads_platform_interface/api/gamepad_event.dart';
 /// calling [update] with the latest [GamepadEvent]. The [analogInputs] and
 /// [buttonInputs] maps correspond to [KeyType.analog] and [KeyType.button],
 /// respectively.
+///
+/// Snapshots and events can arrive out of order; when the platform numbers
+/// them, events already included in the last snapshot and snapshots older
+/// than the last event are ignored.
 class GamepadState {
   /// Contains inputs from events where [GamepadEvent.type] is [KeyType.analog].
   final Map<String, double> analogInputs = {};
@@ -13,8 +18,19 @@ class GamepadState {
   /// Contains inputs from events where [GamepadEvent.type] is [KeyType.button].
   final Map<String, bool> buttonInputs = {};
 
+  // The sequence number of the last event or snapshot applied, if numbered.
+  int _sequence = -1;
+
   /// Updates the state based on the given event.
   void update(GamepadEvent event) {
+    final sequence = event.sequence;
+    if (sequence != null) {
+      if (sequence <= _sequence) {
+        // Already part of a snapshot that was delivered first.
+        return;
+      }
+      _sequence = sequence;
+    }
     switch (event.type) {
       case KeyType.analog:
         analogInputs[event.key] = event.value;
@@ -22,4 +38,22 @@ class GamepadState {
         buttonInputs[event.key] = event.value != 0;
     }
   }
+
+  /// Replaces the whole state with the given snapshot.
+  void seed(GamepadSnapshot snapshot) {
+    final sequence = snapshot.sequence;
+    if (sequence != null) {
+      if (sequence < _sequence) {
+        // Taken before an event that was delivered first.
+        return;
+      }
+      _sequence = sequence;
+    }
+    analogInputs
+      ..clear()
+      ..addAll(snapshot.analogInputs);
+    buttonInputs
+      ..clear()
+      ..addAll(snapshot.buttonInputs);
+  }
 }
@@ -1,5 +1,8 @@
 import 'package:gamepads_platform_interface/api/gamepad_controller.dart';
 import 'package:gamepads_platform_interface/api/gamepad_event.dart';
+import 'package:gamepads_platform_interface/api/gamepad_history.dart';
+import 'package:gamepads_platform_interface/api/gamepad_pattern.dart';
+import 'package:gamepads_platform_interface/api/gamepad_snapshot.dart';
 import 'package:gamepads_platform_interface/method_channel_gamepads_platform_interface.dart';
 import 'package:plugin_platform_interface/plugin_platform_interface.dart';
 
@@ -23,4 +26,39 @@ abstract class GamepadsPlatformInterface extends PlatformInterface {
 
   Stream<GamepadEvent> eventsByGamepad(String gamepadId) =>
       gamepadEventsStream.where((event) => event.gamepadId == gamepadId);
+
+  /// The whole state of gamepads when they are connected or opened again, on
+  /// platforms that send it at once rather than as [gamepadEventsStream]
+  /// events.
+  Stream<GamepadSnapshot> get gamepadSnapshotsStream => const Stream.empty();
+
+  Stream<GamepadSnapshot> snapshotsByGamepad(String gamepadId) =>
+      gamepadSnapshotsStream.where(
+        (snapshot) => snapshot.gamepadId == gamepadId,
+      );
+
+  /// Registers a [GamepadPattern] to be detected natively on every gamepad.
+  ///
+  /// Matches are reported on [patternMatchesStream], so listeners that only
+  /// care about those patterns don't have to consume [gamepadEventsStream].
+  Future<void> registerPattern(GamepadPattern pattern) {
+    throw UnimplementedError('registerPattern() has not been implemented.');
+  }
+
+  /// Stops detecting the pattern with the given [GamepadPattern.id].
+  Future<void> unregisterPattern(String patternId) {
+    throw UnimplementedError('unregisterPattern() has not been implemented.');
+  }
+
+  /// Returns the inputs of a gamepad with a [GamepadEvent.timestamp] at or
+  /// after [since], as kept by the platform; every input if [since] is zero.
+  Future<GamepadHistory> getHistory(String gamepadId, {int since = 0}) {
+    throw UnimplementedError('getHistory() has not been implemented.');
+  }
+
+  Stream<GamepadPatternMatch> get patternMatchesStream {
+    throw UnimplementedError(
+      'patternMatchesStream has not been implemented.',
+    );
+  }
 }
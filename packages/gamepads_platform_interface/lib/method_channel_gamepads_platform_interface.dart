@@ -4,12 +4,18 @@ import 'package:flutter/foundation.dart';
 import 'package:flutter/services.dart';
 import 'package:gamepads_platform_interface/api/gamepad_controller.dart';
 import 'package:gamepads_platform_interface/api/gamepad_event.dart';
+import 'package:gamepads_platform_interface/api/gamepad_history.dart';
+import 'package:gamepads_platform_interface/api/gamepad_pattern.dart';
+import 'package:gamepads_platform_interface/api/gamepad_snapshot.dart';
 import 'package:gamepads_platform_interface/gamepads_platform_interface.dart';
 import 'package:gamepads_platform_interface/method_channel_interface.dart';
 
 class MethodChannelGamepadsPlatformInterface extends GamepadsPlatformInterface {
   final MethodChannel _channel = const MethodChannel('xyz.luan/gamepads');
 
+  @protected
+  MethodChannel get channel => _channel;
+
   MethodChannelGamepadsPlatformInterface() {
     _channel.setMethodCallHandler(platformCallHandler);
   }
@@ -25,26 +31,114 @@ class MethodChannelGamepadsPlatformInterface extends GamepadsPlatformInterface {
     }).toList();
   }
 
+  @override
+  Future<void> registerPattern(GamepadPattern pattern) {
+    return _channel.call('registerPattern', pattern.toMap());
+  }
+
+  @override
+  Future<void> unregisterPattern(String patternId) {
+    return _channel.call('unregisterPattern', <String, dynamic>{
+      'id': patternId,
+    });
+  }
+
+  @override
+  Future<GamepadHistory> getHistory(String gamepadId, {int since = 0}) async {
+    final bytes = await _channel.compute<Uint8List>(
+      'getHistory',
+      <String, dynamic>{'gamepadId': gamepadId, 'since': since},
+    );
+    return GamepadHistory(gamepadId, bytes!);
+  }
+
   Future<void> platformCallHandler(MethodCall call) async {
     switch (call.method) {
       case 'onGamepadEvent':
         emitGamepadEvent(GamepadEvent.parse(call.args));
+      case 'onGamepadSnapshot':
+        _gamepadSnapshotsStreamController.add(
+          GamepadSnapshot.parse(call.args),
+        );
+      case 'onPatternMatched':
+        _patternMatchesStreamController.add(
+          GamepadPatternMatch.parse(call.args),
+        );
     }
   }
 
   void emitGamepadEvent(GamepadEvent event) {
     _gamepadEventsStreamController.add(event);
+    _gamepadStreamControllers[event.gamepadId]?.add(event);
   }
 
-  final StreamController<GamepadEvent> _gamepadEventsStreamController =
-      StreamController<GamepadEvent>.broadcast();
+  /// Tells the platform whether the events of every gamepad (or only those of
+  /// [gamepadId]) are needed, so it can skip reading and sending them while
+  /// nobody listens (e.g. when only patterns are used).
+  @protected
+  Future<void> setEventsEnabled({
+    required bool enabled,
+    String? gamepadId,
+  }) async {
+    try {
+      await _channel.call('setEventsEnabled', <String, dynamic>{
+        'enabled': enabled,
+        'gamepadId': ?gamepadId,
+      });
+    } on MissingPluginException {
+      // Platforms that don't support it always send every event.
+    }
+  }
+
+  late final StreamController<GamepadEvent> _gamepadEventsStreamController =
+      StreamController<GamepadEvent>.broadcast(
+        onListen: () => setEventsEnabled(enabled: true),
+        onCancel: () => setEventsEnabled(enabled: false),
+      );
+
+  final Map<String, StreamController<GamepadEvent>> _gamepadStreamControllers =
+      {};
+
+  final StreamController<GamepadSnapshot> _gamepadSnapshotsStreamController =
+      StreamController<GamepadSnapshot>.broadcast();
+
+  final StreamController<GamepadPatternMatch> _patternMatchesStreamController =
+      StreamController<GamepadPatternMatch>.broadcast();
 
   @override
   Stream<GamepadEvent> get gamepadEventsStream =>
       _gamepadEventsStreamController.stream;
 
+  @override
+  Stream<GamepadEvent> eventsByGamepad(String gamepadId) {
+    return _gamepadStreamControllers
+        .putIfAbsent(
+          gamepadId,
+          () => StreamController<GamepadEvent>.broadcast(
+            onListen: () =>
+                setEventsEnabled(enabled: true, gamepadId: gamepadId),
+            onCancel: () =>
+                setEventsEnabled(enabled: false, gamepadId: gamepadId),
+          ),
+        )
+        .stream;
+  }
+
+  @override
+  Stream<GamepadSnapshot> get gamepadSnapshotsStream =>
+      _gamepadSnapshotsStreamController.stream;
+
+  @override
+  Stream<GamepadPatternMatch> get patternMatchesStream =>
+      _patternMatchesStreamController.stream;
+
   @mustCallSuper
   Future<void> dispose() async {
     _gamepadEventsStreamController.close();
+    for (final controller in _gamepadStreamControllers.values) {
+      controller.close();
+    }
+    _gamepadSnapshotsStreamController.close();
+    _patternMatchesStreamController.close();
   }
 }